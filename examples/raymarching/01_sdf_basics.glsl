@@ -34,7 +34,7 @@ uniform vec3 iResolution;
 
 // Maximum ray march iterations (higher = more accurate but slower)
 // @group("Raymarching")
-// @slider(min=10, max=300, default=100)
+// @slider(min=10, max=300, default=100, quality=true)
 uniform int maxSteps;
 
 // Maximum ray travel distance
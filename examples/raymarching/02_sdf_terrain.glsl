@@ -95,7 +95,7 @@ float fbm(vec2 p, int octaves) {
 // =============================================================================
 
 // @group("Raymarching")
-// @slider(min=50, max=500, default=200)
+// @slider(min=50, max=500, default=200, quality=true)
 uniform int maxSteps;
 
 // @group("Raymarching")
@@ -228,7 +228,7 @@ uniform float aoStrength;
 uniform float aoRadius;
 
 // @group("Ambient Occlusion")
-// @slider(min=1, max=8, default=5)
+// @slider(min=1, max=8, default=5, quality=true)
 uniform int aoSamples;
 
 // =============================================================================
@@ -248,7 +248,7 @@ uniform float shadowStrength;
 uniform float shadowSoftness;
 
 // @group("Shadows")
-// @slider(min=16, max=128, default=64)
+// @slider(min=16, max=128, default=64, quality=true)
 uniform int shadowSteps;
 
 // @group("Shadows")
@@ -275,7 +275,7 @@ uniform float detailNormalStrength;
 uniform float detailNormalScale;
 
 // @group("Detail Normals")
-// @slider(min=1, max=4, default=3)
+// @slider(min=1, max=4, default=3, quality=true)
 uniform int detailNormalOctaves;
 
 // =============================================================================
@@ -530,6 +530,7 @@ float calculateSoftShadow(vec3 origin, vec3 lightDir) {
     float shadow = 1.0;
     float t = shadowBias;  // Start slightly away from surface to avoid self-shadowing
     
+    // @costloop
     for (int i = 0; i < shadowSteps; i++) {
         if (t >= shadowMaxDistance) break;
         
@@ -730,6 +731,7 @@ SceneResult rayMarch(vec3 rayOrigin, vec3 rayDirection) {
     result.materialID = 0.0;
     result.heightNormalized = 0.0;
     
+    // @costloop
     for (int i = 0; i < maxSteps; i++) {
         vec3 currentPos = rayOrigin + rayDirection * totalDistance;
         result = getScene(currentPos);
@@ -25,6 +25,10 @@
 uniform float iTime;
 uniform vec3 iResolution;
 
+// Scene distance for coneMarch() (depth prepass), defined further down
+#define SDF_CONE_MARCH getSceneDistance
+#include "sdf/operations.glsl"
+
 // =============================================================================
 // NOISE & HASH FUNCTIONS
 // =============================================================================
@@ -72,7 +76,7 @@ float valueNoise(vec2 p) {
 // =============================================================================
 
 // @group("Raymarching")
-// @slider(min=50, max=1000, default=150)
+// @slider(min=50, max=1000, default=150, quality=true)
 uniform int maxSteps;
 
 // @group("Raymarching")
@@ -310,7 +314,7 @@ uniform float shadowStrength;
 uniform float shadowSoftness;
 
 // @group("Shadows")
-// @slider(min=16, max=64, default=32)
+// @slider(min=16, max=64, default=32, quality=true)
 uniform int shadowSteps;
 
 // @group("Ambient Occlusion")
@@ -967,6 +971,7 @@ float calculateShadow(vec3 origin, vec3 lightDir) {
     float shadow = 1.0;
     float t = 0.1;
     
+    // @costloop
     for (int i = 0; i < shadowSteps; i++) {
         if (t > maxDistance * 0.5) break;
         
@@ -1443,12 +1448,13 @@ vec3 getMaterialColor(SceneResult hit, vec3 p, vec3 normal) {
 // RAYMARCHING
 // =============================================================================
 
-SceneResult rayMarch(vec3 ro, vec3 rd) {
-    float t = 0.0;
+SceneResult rayMarch(vec3 ro, vec3 rd, float tStart) {
+    float t = tStart;
     SceneResult result;
     result.distance = -1.0;
     result.materialID = -1;
     
+    // @costloop
     for (int i = 0; i < maxSteps; i++) {
         vec3 p = ro + rd * t;
         result = getScene(p);
@@ -1672,8 +1678,16 @@ void main() {
     
     vec3 rayDir = getCameraRay(uv);
     
-    // Raymarch
-    SceneResult hit = rayMarch(uCameraPosition, rayDir);
+#ifdef KIWI_DEPTH_PREPASS
+    // Coarse pass: one conservative cone per pixel, output the distance to skip
+    float focalLength = 1.0 / tan(radians(uCameraFOV) * 0.5);
+    float coneSlope = depthPrepassConeSlope(2.0 / (iResolution.y * focalLength));
+    fragColor = vec4(coneMarch(uCameraPosition, rayDir, coneSlope, maxDistance, maxSteps, 0.8), 0.0, 0.0, 1.0);
+    return;
+#endif
+    
+    // Raymarch (starting where the depth prepass says it is safe, if enabled)
+    SceneResult hit = rayMarch(uCameraPosition, rayDir, depthPrepassStart(fragCoord));
     
     vec3 finalColor;
     float hitDist = hit.distance > 0.0 ? hit.distance : maxDistance;
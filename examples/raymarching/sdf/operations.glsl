@@ -388,6 +388,77 @@ vec3 opBendX(vec3 position, float amount) {
 }
 
 
+// =============================================================================
+// DEPTH PREPASS (Safe ray start distance from a coarse cone-marched pass)
+// =============================================================================
+// When the depth prepass is enabled, ShaderLayer first renders the shader at
+// 1/4 or 1/8 resolution with KIWI_DEPTH_PREPASS defined. That pass marches one
+// cone per coarse pixel (wide enough to contain every full-resolution ray in
+// it) and writes the distance it can safely skip to fragColor.r. The full pass
+// then starts marching at that distance instead of t = 0.
+//
+// Uniforms (set by ShaderLayer):
+//   iDepthPrepass        - R32F texture with the safe start distances
+//   iDepthPrepassEnabled - 1 when iDepthPrepass holds this frame's distances
+//   iDepthPrepassFactor  - Coarse pixel size in full-resolution pixels
+//
+// Visual (side view, one coarse pixel):
+//   camera  >----------------___________  <- cone stops where the scene
+//            \___ skipped ___/    |####|     first touches its radius
+//                              start  scene
+//
+uniform sampler2D iDepthPrepass;
+uniform int iDepthPrepassEnabled;
+uniform float iDepthPrepassFactor;
+
+// Safe starting distance for the ray through uv (fragCoord, 0..1)
+// Returns 0.0 when no prepass ran this frame.
+float depthPrepassStart(vec2 uv) {
+    if (iDepthPrepassEnabled == 0) return 0.0;
+    ivec2 size = textureSize(iDepthPrepass, 0);
+    ivec2 texel = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);
+    return texelFetch(iDepthPrepass, texel, 0).r;
+}
+
+// Cone radius per unit distance that covers a whole coarse pixel
+//   pixelAngle - Angle subtended by one full-resolution pixel (radians)
+float depthPrepassConeSlope(float pixelAngle) {
+    return pixelAngle * iDepthPrepassFactor * 0.7072;  // Half diagonal of the coarse pixel
+}
+
+// Cone marching needs the scene's distance function. Define SDF_CONE_MARCH to
+// its name BEFORE including this file (it may be defined later in the shader):
+//   #define SDF_CONE_MARCH getSceneDistance
+//   #include "sdf/operations.glsl"
+//
+// Parameters:
+//   ro, rd        - Ray origin and normalized direction of the cone axis
+//   coneSlope     - From depthPrepassConeSlope()
+//   maxDistance   - Far limit
+//   maxSteps      - Iteration budget
+//   distanceScale - Same relaxation factor the main march uses (1.0 = exact SDF)
+//
+// Returns: Distance every ray inside the cone can skip
+//
+// Math: a step is safe for all rays in the cone if it stays inside the empty
+//   sphere around the axis point: dt = (d - t*slope) / (1 + slope)
+//
+#ifdef SDF_CONE_MARCH
+float SDF_CONE_MARCH(vec3 p);
+
+float coneMarch(vec3 ro, vec3 rd, float coneSlope, float maxDistance, int maxSteps, float distanceScale) {
+    float t = 0.0;
+    for (int i = 0; i < maxSteps; i++) {
+        float d = SDF_CONE_MARCH(ro + rd * t) * distanceScale;
+        float coneRadius = t * coneSlope;
+        if (d <= coneRadius || t >= maxDistance) break;
+        t += (d - coneRadius) / (1.0 + coneSlope);
+    }
+    return min(t, maxDistance);
+}
+#endif
+
+
 // =============================================================================
 // Usage Examples:
 // =============================================================================
@@ -418,5 +489,13 @@ vec3 opBendX(vec3 position, float amount) {
 //   float decoration = sdSphere(p - vec3(0,1,0), 0.8);
 //   float result = opSmoothUnion(withHoles, decoration, 0.2);
 //
+// Example 6: Depth prepass (see DEPTH PREPASS above)
+//   #ifdef KIWI_DEPTH_PREPASS
+//       float slope = depthPrepassConeSlope(2.0 / (iResolution.y * focalLength));
+//       fragColor = vec4(coneMarch(ro, rd, slope, maxDistance, maxSteps, 1.0));
+//       return;
+//   #endif
+//   float t = depthPrepassStart(fragCoord);  // Start the normal march here
+//
 // =============================================================================
 
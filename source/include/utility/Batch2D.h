@@ -0,0 +1,180 @@
+/**
+ * @file Batch2D.h
+ * @brief Batched rendering of 2D draw lists.
+ *
+ * Collects the geometry of Object2D shapes into dynamic vertex/index streams
+ * with the model transform pre-applied and the material color stored per
+ * vertex, then flushes them with one draw call per stream. SDF primitives
+ * (circles, rounded rectangles, rings) are drawn as instances of a unit quad.
+ */
+
+#pragma once
+
+#include "utility/Layer2D.h"
+
+#include <vector>
+
+/**
+ * @brief Vertex layout of the batch streams (32 bytes).
+ */
+struct BatchVertex2D {
+    glm::vec2 position;     ///< world position (model transform applied)
+    float depth;            ///< per-object depth, keeps draw-list order across streams
+    float highlight;        ///< material highlight intensity
+    glm::vec4 color;        ///< material color
+};
+
+/**
+ * @brief Per-instance attributes of an SDF primitive (88 bytes).
+ */
+struct BatchInstance2D {
+    glm::mat3 transform;    ///< model transformation of the unit quad
+    glm::vec4 fillColor;    ///< transparent when not filled
+    glm::vec4 strokeColor;
+    glm::vec4 shape;        ///< (SdfPrimitive2D::Shape, parameter, stroke width in pixels, highlight)
+    float depth;
+};
+
+/**
+ * @brief Per-frame counters of the batch renderer.
+ */
+struct BatchStats2D {
+    size_t objects = 0;     ///< objects submitted
+    size_t fallbacks = 0;   ///< objects drawn through their own draw()
+    size_t vertices = 0;    ///< vertices streamed
+    size_t instances = 0;   ///< SDF primitive instances streamed
+    size_t drawCalls = 0;   ///< draw calls issued by the batches
+};
+
+/**
+ * @brief Batch renderer for 2D draw lists.
+ *
+ * Materials using the flat shader only differ by color and highlight, which are
+ * stored per vertex, so all of them share one triangle stream (fills) and one
+ * line stream (outlines). Objects that cannot be batched (e.g. a material with a
+ * custom shader) flush the pending batch and are drawn through Object::draw().
+ * SDF primitives go to a third, instanced stream with antialiased edges.
+ *
+ * Outlines are flushed after fills, so each object gets its own depth value and
+ * the flush runs with GL_LEQUAL depth testing to keep the draw-list order.
+ *
+ * Usage per frame:
+ * @code
+ *   batch.begin(cameraTransform, mousePosition);
+ *   for (auto& obj : drawList) batch.submit(*obj, obj->transform);
+ *   batch.end();
+ * @endcode
+ */
+class BatchRenderer2D {
+public:
+    BatchRenderer2D();
+    ~BatchRenderer2D();
+
+    // Delete copy constructor and assignment
+    BatchRenderer2D(const BatchRenderer2D&) = delete;
+    BatchRenderer2D& operator=(const BatchRenderer2D&) = delete;
+
+    /**
+     * @brief Start a new frame. Clears the depth buffer of the current target.
+     * @param camera Camera transformation of the layer
+     * @param mousePosition Normalized mouse position (for highlighting)
+     */
+    void begin(const glm::mat3& camera, glm::vec2 mousePosition);
+
+    /**
+     * @brief Add an object to the batch, or draw it directly if it cannot be batched.
+     * @param object Object to draw
+     * @param model Full model transformation of the object
+     */
+    void submit(Object2D& object, const glm::mat3& model);
+
+    /**
+     * @brief Flush the remaining geometry.
+     */
+    void end();
+
+    [[nodiscard]] inline const BatchStats2D& getStats() const { return stats_; }
+
+public: // Geometry API for Object2D::appendToBatch()
+    /**
+     * @brief Whether geometry using this material can be added to the batch.
+     */
+    [[nodiscard]] static bool accepts(const std::shared_ptr<Material>& material);
+
+    /**
+     * @brief Add a filled triangle fan around points[0].
+     */
+    void addTriangleFan(const glm::vec2* points, size_t count, const glm::mat3& model, const Material& material);
+
+    /**
+     * @brief Add indexed triangles over the points (e.g. a cached polygon triangulation).
+     */
+    void addTriangles(const glm::vec2* points, size_t count, const unsigned int* indices, size_t indexCount,
+                      const glm::mat3& model, const Material& material);
+
+    /**
+     * @brief Add a closed outline through all points.
+     */
+    void addLineLoop(const glm::vec2* points, size_t count, const glm::mat3& model, const Material& material);
+
+    /**
+     * @brief Add a single line segment.
+     */
+    void addLine(glm::vec2 from, glm::vec2 to, const glm::mat3& model, const Material& material);
+
+    /**
+     * @brief Add an SDF primitive instance drawn on the unit quad [-0.5, 0.5]^2.
+     * @param shape Distance function of the primitive
+     * @param parameter Shape parameter (corner radius or inner radius, see SdfPrimitive2D)
+     * @param strokeWidth Outline width in pixels, drawn inside the edge
+     * @param model Full model transformation of the object
+     * @param fill Fill material, nullptr for outline only
+     * @param stroke Stroke material, nullptr for no outline
+     */
+    void addInstance(SdfPrimitive2D::Shape shape, float parameter, float strokeWidth, const glm::mat3& model,
+                     const Material* fill, const Material* stroke);
+
+private:
+    /**
+     * @brief Dynamic vertex (and optional index) stream with its own VAO.
+     */
+    struct Stream {
+        unsigned int vertexArray{};
+        unsigned int vertexBuffer{};
+        unsigned int indexBuffer{};
+        size_t vertexCapacity = 0;
+        size_t indexCapacity = 0;
+        std::vector<BatchVertex2D> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    /**
+     * @brief Instanced stream: a static unit quad plus a dynamic instance buffer.
+     */
+    struct InstanceStream {
+        unsigned int vertexArray{};
+        unsigned int quadBuffer{};
+        unsigned int instanceBuffer{};
+        size_t capacity = 0;
+        std::vector<BatchInstance2D> instances;
+    };
+
+    void createStream(Stream& stream, bool indexed);
+    void createInstanceStream();
+    static void destroyStream(Stream& stream);
+    void upload(Stream& stream);
+    void flush();
+    [[nodiscard]] BatchVertex2D makeVertex(glm::vec2 point, const glm::mat3& model, const Material& material) const;
+
+    std::shared_ptr<Shader> shader_;
+    std::shared_ptr<Shader> sdfShader_;
+    Stream triangles_;
+    Stream lines_;
+    InstanceStream sdf_;
+
+    glm::mat3 camera_{1.0f};
+    glm::vec2 mousePosition_{};
+    size_t objectIndex_ = 0;
+    float depth_ = 1.0f;
+    BatchStats2D stats_;
+};
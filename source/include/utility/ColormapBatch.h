@@ -0,0 +1,60 @@
+/**
+ * @file ColormapBatch.h
+ * @brief Batch colormapping of float arrays on the CPU (image export, preprocessing).
+ */
+
+#pragma once
+
+#include "utility/colormaps.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief Map arrays of values through the ColormapTables colormaps.
+ *
+ * Values are normalized to [minValue, maxValue], clamped (NaN maps to the
+ * low end, as in Material::getColor) and linearly interpolated between the
+ * 512 table entries. Eight values at a time go through AVX2 (index
+ * computation, gathers and interpolation) when the CPU supports it; the
+ * scalar path produces the same results and is used for the tail and on
+ * other CPUs.
+ */
+namespace ColormapBatch {
+    /**
+     * @brief Write one packed RGBA8 pixel per value (R in the lowest byte).
+     * @param out At least values.size() pixels
+     */
+    void mapToRGBA8(std::span<const float> values, float minValue, float maxValue, Colormap colormap,
+                    uint32_t* out, uint8_t alpha = 255);
+
+    /**
+     * @brief Write three floats in [0, 1] (RGB) per value.
+     * @param out At least 3 * values.size() floats
+     */
+    void mapToRGB(std::span<const float> values, float minValue, float maxValue, Colormap colormap, float* out);
+
+    /**
+     * @brief Whether the AVX2 path is available on this CPU.
+     */
+    [[nodiscard]] bool hasAVX2();
+
+    /**
+     * @brief Force the scalar path (comparisons and benchmarks).
+     */
+    void setSimdEnabled(bool enabled);
+
+    /**
+     * @brief Throughput of both paths, in samples per second (simd is 0 without AVX2).
+     */
+    struct BenchmarkResult {
+        double scalarSamplesPerSecond = 0.0;
+        double simdSamplesPerSecond = 0.0;
+    };
+
+    /**
+     * @brief Time mapToRGBA8 over a buffer of random values and log the result.
+     */
+    BenchmarkResult benchmark(size_t samples = 1 << 22, int repetitions = 8);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file ColormapTextures.h
+ * @brief Shared 1D lookup textures of the ColormapTables colormaps.
+ */
+
+#pragma once
+
+#include "utility/colormaps.h"
+
+#include <glad/glad.h>
+
+/**
+ * @brief 1D RGB8 lookup textures of all colormaps, uploaded once per context.
+ *
+ * Each table is uploaded on its first request and shared by everything that
+ * colormaps on the GPU (heatmaps, scalar fields, ...). The textures use linear
+ * filtering and clamp to the edges, so `texture(lut, t)` with t in [0, 1]
+ * interpolates between the 512 entries.
+ */
+class ColormapTextures {
+public:
+    /**
+     * @brief Get the lookup texture of a colormap (requires a current OpenGL context).
+     */
+    static GLuint get(Colormap colormap);
+
+    /**
+     * @brief Delete all uploaded textures (before the context is destroyed).
+     */
+    static void release();
+};
@@ -0,0 +1,103 @@
+/**
+ * @file CostHeatmap.h
+ * @brief Per-pixel cost visualization for instrumented shaders.
+ *
+ * Captures the iteration counts written by a shader instrumented with
+ * ShaderPreprocessor::instrumentCostLoops() and displays them as a heatmap
+ * through a 1D colormap lookup texture.
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+/**
+ * @brief Colormaps available for the heatmap (from ColormapTables).
+ */
+enum class HeatmapColormap {
+    Viridis,
+    Blackbody
+};
+
+/**
+ * @brief Statistics over the captured per-pixel cost.
+ */
+struct CostStats {
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+};
+
+/**
+ * @brief Offscreen capture of per-pixel cost and its heatmap display.
+ *
+ * Usage per frame:
+ * @code
+ *   heatmap.begin(width, height);   // Redirects drawing to the capture target
+ *   // ... draw the instrumented program ...
+ *   heatmap.end(quadVAO);           // Reads stats, draws the heatmap to the previous target
+ * @endcode
+ */
+class CostHeatmap {
+public:
+    CostHeatmap() = default;
+    ~CostHeatmap();
+
+    // Delete copy constructor and assignment
+    CostHeatmap(const CostHeatmap&) = delete;
+    CostHeatmap& operator=(const CostHeatmap&) = delete;
+
+    /**
+     * @brief Bind the capture target (color at attachment 0, cost at attachment 1).
+     * @param width Capture width in pixels
+     * @param height Capture height in pixels
+     * @return false if the capture target could not be created
+     */
+    bool begin(int width, int height);
+
+    /**
+     * @brief Restore the previous target, update stats and draw the heatmap.
+     * @param quadVAO VAO of a fullscreen quad with positions in [-1,1] at location 0
+     */
+    void end(GLuint quadVAO);
+
+    /**
+     * @brief Select the colormap used for display.
+     */
+    void setColormap(HeatmapColormap colormap);
+    [[nodiscard]] HeatmapColormap getColormap() const { return colormap_; }
+
+    /**
+     * @brief Get min/max/mean cost of the last captured frame.
+     */
+    [[nodiscard]] const CostStats& getStats() const { return stats_; }
+
+private:
+    bool initialize();
+    void resize(int width, int height);
+    void updateStats();
+
+    // Capture target
+    GLuint framebuffer_ = 0;
+    GLuint colorTexture_ = 0;
+    GLuint costTexture_ = 0;  // R32F iteration counts
+    int width_ = 0;
+    int height_ = 0;
+
+    // Display
+    GLuint program_ = 0;
+    GLint costTextureLoc_ = -1;
+    GLint colormapLoc_ = -1;
+    GLint costRangeLoc_ = -1;
+    HeatmapColormap colormap_ = HeatmapColormap::Viridis;
+    bool initialized_ = false;
+
+    // State restored in end()
+    GLint previousFramebuffer_ = 0;
+    GLint previousViewport_[4] = {0, 0, 0, 0};
+
+    // Readback for statistics
+    std::vector<float> readback_;
+    CostStats stats_;
+};
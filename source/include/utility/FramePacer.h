@@ -0,0 +1,97 @@
+/**
+ * @file FramePacer.h
+ * @brief Frame pacing of the main window: vsync, uncapped, capped and adaptive.
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+
+/**
+ * @brief How the main loop is paced.
+ */
+enum class FramePacing {
+    VSync,      ///< swap interval 1
+    Uncapped,   ///< swap interval 0, as fast as possible (tearing)
+    Capped,     ///< swap interval 0, sleep-plus-spin to a target rate
+    Adaptive    ///< vsync, but late frames are shown right away (EXT_swap_control_tear)
+};
+
+/**
+ * @brief Paces the frames of the main window and limits the frames queued on the GPU.
+ *
+ * The capped mode sleeps until shortly before the frame deadline and spins the rest:
+ * the OS scheduler alone overshoots by up to a timer tick, so the margin left for
+ * spinning follows the overshoot measured on earlier sleeps. Adaptive vsync falls back
+ * to vsync when the driver lacks the swap-control-tear extension.
+ *
+ * With the frame queue limited, the next frame only starts once the GPU is done with
+ * the previous one, so input is sampled as late as possible (lower latency, less
+ * overlap of CPU and GPU work).
+ *
+ * Usage per frame:
+ * @code
+ *   pacer.beginFrame();         // applies a mode change, waits for the GPU if limited
+ *   ...                         // build and draw the frame
+ *   pacer.waitForDeadline();    // capped mode only
+ *   glfwSwapBuffers(window);
+ *   pacer.endFrame();
+ * @endcode
+ */
+class FramePacer {
+public:
+    static constexpr double MIN_TARGET_RATE = 10.0;
+    static constexpr double MAX_TARGET_RATE = 1000.0;
+
+    ~FramePacer();
+
+    void setMode(FramePacing mode);
+    [[nodiscard]] inline FramePacing getMode() const { return mode_; }
+
+    /**
+     * @brief Frames per second of the capped mode.
+     */
+    void setTargetRate(double rate);
+    [[nodiscard]] inline double getTargetRate() const { return targetRate_; }
+
+    /**
+     * @brief Start the next frame only when the GPU finished the previous one.
+     */
+    inline void setLimitFrameQueue(bool limit) { limitFrameQueue_ = limit; }
+    [[nodiscard]] inline bool isFrameQueueLimited() const { return limitFrameQueue_; }
+
+    /**
+     * @brief Call on the UI thread with the window context current, before the frame.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Capped mode: wait for the frame deadline (call right before the swap).
+     */
+    void waitForDeadline();
+
+    /**
+     * @brief Call right after the swap.
+     */
+    void endFrame();
+
+    /**
+     * @brief Release the GPU objects (before the context is destroyed).
+     */
+    void release();
+
+    static const char* getModeName(FramePacing mode);
+
+private:
+    void applySwapInterval();
+
+    FramePacing mode_ = FramePacing::VSync;
+    bool modeChanged_ = true;
+    double targetRate_ = 120.0;
+    bool limitFrameQueue_ = false;
+
+    double deadline_ = 0.0;         // capped mode: when the next frame is due
+    double spinMargin_ = 0.002;     // seconds left for spinning before the deadline
+
+    GLsync frameFence_ = nullptr;   // end of the last swapped frame
+};
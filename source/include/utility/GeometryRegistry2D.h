@@ -0,0 +1,72 @@
+/**
+ * @file GeometryRegistry2D.h
+ * @brief Shared GPU geometry of the 2D primitives.
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Draw ranges of a unit mesh in the shared vertex array.
+ */
+struct UnitMesh2D {
+    GLint fillFirst = 0;        ///< GL_TRIANGLE_FAN
+    GLsizei fillCount = 0;
+    GLint outlineFirst = 0;     ///< GL_LINE_LOOP
+    GLsizei outlineCount = 0;
+};
+
+/**
+ * @brief One copy of every unit mesh and a pooled buffer of line segments.
+ *
+ * Rectangles and circles all draw the same unit geometry (the transform does the
+ * rest), so it is uploaded once into a single vertex array instead of per object.
+ * Line segments differ per object: they are sub-allocated from one growing vertex
+ * buffer with a free list, so creating or destroying a line does not create or
+ * delete any OpenGL object. All functions need the current OpenGL context.
+ */
+class GeometryRegistry2D {
+public:
+    enum class Mesh {
+        Rectangle,
+        Circle
+    };
+
+    /**
+     * @brief Segments used to approximate the unit circle (batched circles are drawn as SDF).
+     */
+    static constexpr int CIRCLE_SEGMENTS = 32;
+
+    /**
+     * @brief Bind the vertex array of the unit meshes and get the ranges of a mesh.
+     */
+    static const UnitMesh2D& bindMesh(Mesh mesh);
+
+    /**
+     * @brief Reserve a segment slot (two vertices) in the shared line buffer.
+     */
+    static uint32_t allocateSegment(glm::vec2 start, glm::vec2 end);
+    static void setSegment(uint32_t segment, glm::vec2 start, glm::vec2 end);
+    static void releaseSegment(uint32_t segment);
+
+    /**
+     * @brief Bind the vertex array of the line buffer (uploads pending changes).
+     * Segment s is drawn with glDrawArrays(GL_LINES, 2 * s, 2).
+     */
+    static void bindSegments();
+
+    /**
+     * @brief Segments in use, for statistics.
+     */
+    [[nodiscard]] static size_t getSegmentCount();
+
+    /**
+     * @brief Delete all OpenGL objects (before the context is destroyed).
+     */
+    static void release();
+};
@@ -0,0 +1,82 @@
+/**
+ * @file LatencyProbe.h
+ * @brief Input-to-present latency measurement with GL timestamps.
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief Measures how long input takes to reach the screen.
+ *
+ * Input events are stamped when GLFW delivers them. The first frame drawn after an
+ * event takes the oldest unseen stamp, and a GL timestamp query right after its swap
+ * tells when the GPU got through the frame; GPU time is mapped to the CPU clock through
+ * the current GL_TIMESTAMP. The result spans input delivery, frame building, queued
+ * frames and the GPU work up to the swap; scanout of the display is not included.
+ *
+ * All functions are called from the UI thread, with the window context current.
+ */
+class LatencyProbe {
+public:
+    static constexpr size_t HISTORY = 64;       ///< samples in the statistics
+
+    ~LatencyProbe();
+
+    void setEnabled(bool enabled);
+    [[nodiscard]] inline bool isEnabled() const { return enabled_; }
+
+    /**
+     * @brief An input event arrived (glfwGetTime() of its delivery).
+     */
+    void onInput(double time);
+
+    /**
+     * @brief The frame about to be drawn takes the input received so far (late latching point).
+     */
+    void latchFrame();
+
+    /**
+     * @brief Call right after the swap of a frame.
+     */
+    void endFrame();
+
+    /**
+     * @brief Latency of the last measured frame, in milliseconds (0 before the first).
+     */
+    [[nodiscard]] inline double getLastLatency() const { return lastLatency_; }
+    [[nodiscard]] double getAverageLatency() const;
+    [[nodiscard]] double getMaxLatency() const;
+    [[nodiscard]] inline size_t getSampleCount() const { return sampleCount_; }
+
+    /**
+     * @brief Release the GPU objects (before the context is destroyed).
+     */
+    void release();
+
+private:
+    static constexpr int QUERY_COUNT = 8;       // frames in flight that can be measured
+
+    struct PendingQuery {
+        GLuint query = 0;
+        double inputTime = 0.0;
+        bool pending = false;
+    };
+
+    void collect();
+
+    bool enabled_ = false;
+    double unseenInput_ = -1.0;     // oldest input not taken by a frame yet
+    double frameInput_ = -1.0;      // input taken by the frame being drawn
+
+    std::array<PendingQuery, QUERY_COUNT> queries_{};
+    int nextQuery_ = 0;
+
+    std::array<double, HISTORY> samples_{};
+    size_t sampleCount_ = 0;
+    double lastLatency_ = 0.0;
+};
@@ -20,9 +20,21 @@
 
 #include "utility/shader.h"
 #include "utility/colormaps.h"
+#include "utility/SpatialIndex2D.h"
 
 #define KIWI_API
 
+class BatchRenderer2D;
+struct BatchStats2D;
+class RenderQueue2D;
+struct RenderQueueStats2D;
+class KiwiLayer2D;
+class SceneNode2D;
+struct SceneStats2D;
+class PlotSeries2D;
+class KiwiFrame;
+class RenderThread;
+
 /**
  * @brief Represents an event structure, particularly for mouse button actions.
  *
@@ -113,6 +125,10 @@ public:
     virtual inline void setColor(glm::vec4 color) {this->color = color;}
     virtual void setHighlight(float highlight);
 
+    [[nodiscard]] inline const std::shared_ptr<Shader>& getShader() const {return shader;}
+    [[nodiscard]] inline glm::vec4 getColor() const {return color;}
+    [[nodiscard]] inline float getHighlight() const {return highlightIntensity;}
+
 private:
     std::shared_ptr<Shader> shader;
     glm::vec4 color;
@@ -121,6 +137,7 @@ private:
 public:
     static std::shared_ptr<Material> createFlatMaterial(const glm::vec4& color);
     static glm::vec4 getColorViridis(float value, float alpha=1.0);
+    static glm::vec4 getColor(Colormap colormap, float value, float alpha=1.0);
     // Other methods...
 
     // Predefined colors
@@ -168,6 +185,38 @@ public:
     Object2D() = default;
    // virtual ~Object2D();
     glm::mat3 transform = glm::mat3(1.0);
+
+    /**
+     * @brief Add this object's geometry to a batch instead of drawing it.
+     * @param batch Batch renderer of the layer
+     * @param model Full model transformation of the object
+     * @return false if the object cannot be batched (it is then drawn with draw())
+     */
+    virtual bool appendToBatch(BatchRenderer2D& /*batch*/, const glm::mat3& /*model*/) { return false; }
+
+    /**
+     * @brief Add this object to a render queue (containers add their children instead).
+     * @param queue Render queue of the layer
+     * @param model Full model transformation of the object
+     */
+    virtual void appendToQueue(RenderQueue2D& queue, const glm::mat3& model);
+
+    /**
+     * @brief Material the render queue sorts this object by, nullptr keeps it in submission order.
+     */
+    [[nodiscard]] virtual const Material* getSortMaterial() const { return nullptr; }
+
+    /**
+     * @brief Whether the object blends with what is behind it (drawn in submission order).
+     */
+    [[nodiscard]] virtual bool isTranslucent() const { return false; }
+
+    /**
+     * @brief Bounds of the geometry before `transform` is applied (minX, minY, maxX, maxY).
+     * Shapes are unit-sized by default; an unbounded object (never culled) returns
+     * (lowest, lowest, max, max).
+     */
+    [[nodiscard]] virtual glm::vec4 getLocalBounds() const { return {-0.5f, -0.5f, 0.5f, 0.5f}; }
 };
 
 /**
@@ -190,62 +239,60 @@ public:
 
     void setStrokeMaterial(std::shared_ptr<Material> mat) ;
     [[nodiscard]] std::shared_ptr<Material> getStrokeMaterial() const;
+
+    [[nodiscard]] const Material* getSortMaterial() const override;
+    [[nodiscard]] bool isTranslucent() const override;
 };
 
 /**
  * @brief A 2D rectangle object, inheriting from MaterialObject2D.
  *
  * Represents a rectangle in 2D space with customizable fill and stroke materials.
- * It maintains its own vertex array, vertex buffer, and index buffer for rendering.
- * The class provides methods for drawing the rectangle and setting its properties.
+ * All rectangles draw the unit rectangle of GeometryRegistry2D; the transform
+ * places and sizes it. Use makePooled2D to allocate many of them from a pool.
  *
  * @param fillMaterial Shared pointer to the material used for filling the rectangle.
  * @param strokeMaterial Shared pointer to the material used for the rectangle's edges.
  */
 class Rectangle2D : public MaterialObject2D {
 private:
-    unsigned int vertex_array_index{};
-    unsigned int vertexBuffer{};
-    unsigned int indexBuffer{};
     bool drawEdges_ = true;
     bool fill_ = true;
 public:
     void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
     explicit Rectangle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial);
-    ~Rectangle2D();
 };
 
 /**
  * @brief A 2D circle object, inheriting from MaterialObject2D.
  *
  * Represents a circle in 2D space with customizable fill and stroke materials.
- * It handles its own geometry creation, approximating a circle using a specified number of segments.
- * The class allows for rendering the circle with different visual properties.
+ * All circles draw the unit circle of GeometryRegistry2D (GeometryRegistry2D::CIRCLE_SEGMENTS
+ * segments); batched circles are drawn as SDF quads instead.
  *
  * @param fillMaterial Shared pointer to the material used for filling the circle.
  * @param strokeMaterial Shared pointer to the material used for the circle's edges.
  */
 class Circle2D : public MaterialObject2D {
 private:
-    unsigned int vertex_array_index{};
-    unsigned int vertexBuffer{};
-    unsigned int indexBuffer{};
     bool drawEdges_ = true;
     bool fill_ = true;
-    int num_segments = 32; // Number of segments to approximate the circle
 
 public:
     void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
     explicit Circle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial);
-    ~Circle2D();
 };
 
 /**
  * @brief A 2D polygon object, inheriting from MaterialObject2D.
  *
- * Represents a convex polygon in 2D space with customizable fill and stroke materials.
- * The class provides methods for defining the polygon's vertices and drawing the polygon.
- * It also handles its own vertex and index buffers for rendering.
+ * Represents a simple polygon, optionally with holes, in 2D space with customizable fill
+ * and stroke materials. The fill is triangulated by ear clipping and the triangulation is
+ * cached: appending a vertex that only adds an ear to the outer ring adds one triangle,
+ * and moving a vertex keeps the triangulation while its triangles do not flip.
+ * Vertex and index buffers grow by doubling and only the changed ranges are re-uploaded.
  *
  * @param fillMaterial Shared pointer to the material used for filling the polygon.
  * @param strokeMaterial Shared pointer to the material used for the polygon's edges.
@@ -255,93 +302,173 @@ private:
     unsigned int vertex_array_index{};
     unsigned int vertexBuffer{};
     unsigned int indexBuffer{};
-    std::vector<glm::vec2> vertices;
+    std::vector<glm::vec2> vertices;        // outer ring, then the rings of the holes
+    std::vector<size_t> holeStarts;         // first vertex of each hole
+    std::vector<unsigned int> indices;      // cached triangulation
     bool drawEdges_ = true;
     bool fill_ = true;
 
+    // Triangulation cache
+    size_t triangulatedVertices_ = 0;       // vertices covered by `indices`
+    bool retriangulate_ = true;
+
+    // GPU buffers grow by doubling; only the dirty ranges are uploaded
+    size_t vertexCapacity_ = 0;
+    size_t indexCapacity_ = 0;
+    size_t vertexDirtyBegin_ = 0;
+    size_t vertexDirtyEnd_ = 0;
+    size_t indexDirtyBegin_ = 0;            // indices are uploaded from here to the end
+
+    void triangulate();
+    bool appendTriangle(size_t vertex);
+    [[nodiscard]] bool triangleContainsVertex(glm::vec2 a, glm::vec2 b, glm::vec2 c) const;
+    void markVerticesDirty(size_t begin, size_t end);
+    [[nodiscard]] bool needsUpdate() const;
+
 public:
     Polygon2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial);
     ~Polygon2D();
 
-    inline void resetVertices() {vertices.clear(); }
-    void addVertex(const glm::vec2& vertex);
-    void updateVertices(); // Call this after adding all vertices
+    void resetVertices();
+    void addVertex(const glm::vec2& vertex);        // appended to the outer ring, or to the last hole
+    void beginHole();                               // following vertices form a new hole
+    void setVertex(size_t index, const glm::vec2& vertex);
+    [[nodiscard]] inline size_t getVertexCount() const {return vertices.size(); }
+    void updateVertices(); // Triangulate and upload the changes (draw() does it when needed)
     void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
+    [[nodiscard]] glm::vec4 getLocalBounds() const override;
 };
 
 /**
- * @brief A 2D grid object, inheriting from MaterialObject2D.
+ * @brief A 2D primitive defined by a signed distance function on the unit quad.
  *
- * Represents a grid in 2D space, useful for providing a reference frame or background.
- * The grid's spacing and size can be dynamically updated based on zoom level and camera position.
- * It utilizes a vertex buffer for rendering the grid lines.
+ * Inside a batch, all SDF primitives of a layer are drawn as instances of one unit quad,
+ * with antialiased edges and a stroke of constant pixel width computed in the fragment shader.
+ * Outside a batch they fall back to a tessellated approximation drawn with the flat shader.
  *
- * @param material Shared pointer to the material used for the grid lines.
- * @param size The size of the grid.
- * @param spacing The initial spacing between the grid lines.
+ * @param shape Distance function of the primitive
+ * @param parameter Corner radius (RoundedRectangle, fraction of the smaller side, 0..0.5) or
+ *                  inner radius (Ring, fraction of the outer radius, 0..1)
  */
-class Grid2D : public MaterialObject2D {
+class SdfPrimitive2D : public MaterialObject2D {
+public:
+    enum class Shape {
+        Circle = 0, RoundedRectangle = 1, Ring = 2
+    };
+
+    SdfPrimitive2D(Shape shape, float parameter, std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial);
+    ~SdfPrimitive2D();
+
+    void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
+
+    [[nodiscard]] inline Shape getShape() const {return shape_; }
+    inline void setParameter(float parameter) {parameter_ = parameter; geometryDirty_ = true; }
+    [[nodiscard]] inline float getParameter() const {return parameter_; }
+    inline void setStrokeWidth(float pixels) {strokeWidth_ = pixels; }
+    [[nodiscard]] inline float getStrokeWidth() const {return strokeWidth_; }
+    inline void setFill(bool fill) {fill_ = fill; }
+    inline void setDrawEdges(bool drawEdges) {drawEdges_ = drawEdges; }
+
 private:
+    void tessellate();
+
+    Shape shape_;
+    float parameter_;
+    float strokeWidth_ = 1.0f;  // Outline width in pixels (batched only)
+    bool drawEdges_ = true;
+    bool fill_ = true;
+
+    // Fallback geometry: fill triangles followed by outline segments
     unsigned int vertex_array_index{};
     unsigned int vertexBuffer{};
-    int grid_size;
+    int fillVertexCount = 0;
+    int lineVertexCount = 0;
+    bool geometryDirty_ = true;
+};
 
-    void updateVertexBuffer();
-    bool calculateNewSpacing(float zoomLevel, glm::vec2 cameraPosition);
+/**
+ * @brief A 2D rectangle with rounded corners, drawn as an SDF primitive.
+ *
+ * @param cornerRadius Corner radius as a fraction of the smaller side (0..0.5).
+ */
+class RoundedRectangle2D : public SdfPrimitive2D {
 public:
-    float baseSpacing = 1.0f;
-    float line_width = 1.0f;
-    float grid_spacing{};
-    glm::vec2 origin = {0, 0};
-    bool flipAlpha = false;
-    Grid2D(std::shared_ptr<Material> material, int size, float spacing);
-    ~Grid2D();
-
-    void updateGrid(float zoomLevel, glm::vec2 cameraPosition);
-    void draw() override;
+    RoundedRectangle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial, float cornerRadius = 0.1f)
+        : SdfPrimitive2D(Shape::RoundedRectangle, cornerRadius, std::move(fillMaterial), std::move(strokeMaterial)) {}
+};
+
+/**
+ * @brief A 2D ring (annulus), drawn as an SDF primitive.
+ *
+ * @param innerRadius Inner radius as a fraction of the outer radius (0..1).
+ */
+class Ring2D : public SdfPrimitive2D {
+public:
+    Ring2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial, float innerRadius = 0.5f)
+        : SdfPrimitive2D(Shape::Ring, innerRadius, std::move(fillMaterial), std::move(strokeMaterial)) {}
 };
 
 /**
- * @brief A 2D nested grid object, inheriting from Object2D.
+ * @brief An infinite 2D nested grid with major and minor lines.
  *
- * Represents a nested grid composed of two separate Grid2D objects.
- * This class is useful for creating grids with major and minor lines, providing more visual detail.
- * It allows dynamic updates based on zoom level and camera position.
+ * Drawn procedurally in a single fullscreen pass: the fragment shader maps each pixel
+ * through the inverse camera transform and computes its distance to the nearest major
+ * and minor line, antialiased in screen space. The grid level follows the zoom, and the
+ * minor lines fade out as they get denser, so zooming and panning need no vertex data.
  *
- * @param size The size of the grid.
- * @param spacing The spacing for the major grid lines.
+ * @param spacing The spacing for the major grid lines at the base level.
  * @param divisionBy The division factor to determine the spacing of minor grid lines.
  */
-class NestGrid2D : Object2D {
+class NestGrid2D {
 public:
-    NestGrid2D(int size, float spacing, float divisionBy);
+    NestGrid2D(float spacing, float divisionBy);
+    ~NestGrid2D();
+
+    // Delete copy constructor and assignment
+    NestGrid2D(const NestGrid2D&) = delete;
+    NestGrid2D& operator=(const NestGrid2D&) = delete;
+
+    /**
+     * @brief Draw the grid over the whole viewport.
+     * @param inverseCamera Inverse camera transformation (normalized frame -> layer)
+     * @param mousePosition Normalized mouse position (for highlighting)
+     */
+    void draw(const glm::mat3& inverseCamera, glm::vec2 mousePosition);
+
+    inline void setColor(const glm::vec4& color) {color_ = color; }
+    [[nodiscard]] inline const glm::vec4& getColor() const {return color_; }
+    inline void setVisible(bool visible) {visible_ = visible; }
+    [[nodiscard]] inline bool isVisible() const {return visible_; }
 
-    void update(float zoomLevel, glm::vec2 cameraPosition);
-    void draw() override;
 private:
     float spacingMajor;
     float division;
+    glm::vec4 color_{0.3f, 0.3f, 0.3f, 1.0f};
+    bool visible_ = true;
 
-    std::shared_ptr<Grid2D> grid2D;
-    std::shared_ptr<Grid2D> subGrid2D;
+    std::shared_ptr<Shader> shader_;
+    unsigned int vertex_array_index{};  // empty, the fullscreen triangle is generated from gl_VertexID
 };
 
 /**
  * @brief A 2D line object, inheriting from MaterialObject2D.
  *
  * Represents a simple line segment in 2D space with customizable material.
- * It maintains its own vertex array and buffer for rendering.
+ * Its two vertices live in the pooled line buffer of GeometryRegistry2D.
  *
  * @param material Shared pointer to the material used for the line.
  */
 class Line2D : public MaterialObject2D {
 private:
     float x2{}, y2{};
-    unsigned int vertex_array_index{};
-    unsigned int vertexBuffer{};
+    uint32_t segment_;          // slot in the shared line buffer of GeometryRegistry2D
 
 public:
     void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
+    [[nodiscard]] glm::vec4 getLocalBounds() const override;
 
     explicit Line2D(std::shared_ptr<Material> material);
 
@@ -368,7 +495,7 @@ public:
  */
 class Camera2D : public Camera {
 private:
-    friend class Layer2D; friend class KiwiLayer2D;
+    friend class Layer2D; friend class KiwiLayer2D; friend class ScalarFieldLayer2D;
     [[nodiscard]] glm::mat3 getTransformation();
     [[nodiscard]] inline glm::mat3 getInverseTransformation() const { return inverseTransformationMatrix; };
 
@@ -414,16 +541,25 @@ public:
 
     // Override the draw method from Object2D
     void draw() override;
+    bool appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) override;
+    void appendToQueue(RenderQueue2D& queue, const glm::mat3& model) override;
+    // Children are drawn with `child->transform * model`, which has no local box: never culled
+    [[nodiscard]] glm::vec4 getLocalBounds() const override;
 
     // Event handling methods
+    // Cached; recomputed when `transform` changes or after invalidateBounds()
     virtual glm::vec4 getBoundingBox();
 
+    // Call after changing a child's transform (own transform changes are detected)
+    void invalidateBounds();
+    inline void setTransform(const glm::mat3& t) {transform = t; invalidateBounds(); }
+
     void onMouseEvent(MouseEvent mouseEvent);
 
     [[nodiscard]] inline bool isHovering() const {return isHovering_; }
     [[nodiscard]] inline bool isMouseDown() const {return isMouseDown_; }
 
-    inline void add(const std::shared_ptr<Object2D>& obj) {drawList.push_back(obj); }
+    inline void add(const std::shared_ptr<Object2D>& obj) {drawList.push_back(obj); invalidateBounds(); }
     inline void onMouseEnter(const std::function<void(MouseEvent, KiwiComponent2D&)>& callback) { onMouseEnterCallback=callback; };
     inline void onMouseLeave(const std::function<void(MouseEvent, KiwiComponent2D&)>& callback) { onMouseLeaveCallback=callback; };
     inline void onMouseClick(const std::function<void(MouseEvent, KiwiComponent2D&)>& callback) { onMouseClickCallback=callback; };
@@ -447,6 +583,16 @@ private:
     glm::vec2 onClickMousePosition{0.0};
     glm::vec2 oldMousePosition{0.0};
     glm::mat3 onClickTransform{0.0};    ///< temporary transform when the mouse clicked, useful for changing transform
+
+    // Bounds cache
+    glm::vec4 cachedBounds{0.0f};
+    glm::mat3 cachedBoundsTransform{0.0f};
+    bool boundsDirty = true;
+
+    // Owning layer, notified when the bounds are invalidated (for its spatial index)
+    KiwiLayer2D* owner = nullptr;
+    size_t ownerIndex = 0;
+    friend class KiwiLayer2D;
 };
 
 /**
@@ -463,6 +609,42 @@ public:
     virtual inline Camera& getCamera() = 0;
     virtual void updateMousePosition(glm::vec2 normalizedPosition) = 0;
     virtual void handleMouseEvent(MouseEvent mouseEvent) = 0;
+
+    /**
+     * @brief Whether the last rendered image of the layer is out of date.
+     * Layers add their own sources (time dependence, camera, input); the default is invalidate().
+     */
+    [[nodiscard]] virtual bool needsRender() { return dirty_; }
+
+    /**
+     * @brief Whether the layer draws with depth testing (the frame omits its depth buffer otherwise).
+     */
+    [[nodiscard]] virtual bool needsDepthBuffer() const { return true; }
+
+    /**
+     * @brief Whether this frame of the layer can be drawn on the render thread (see RenderThread).
+     */
+    [[nodiscard]] virtual bool supportsRenderThread() const { return false; }
+
+    /**
+     * @brief Do everything render() does except drawing, on the UI thread, and return the draw.
+     * The returned function runs on the render thread and may only use its own copies.
+     */
+    virtual std::function<void()> captureRenderJob(const RenderThread& /*thread*/, float /*windowWidth*/,
+                                                   float /*windowHeight*/, double /*time*/,
+                                                   double /*deltaTime*/) { return {}; }
+
+    // Caching: the layer renders into its own texture only when needsRender(), and the
+    // texture is composited into the frame every frame
+    inline void setCached(bool cached) {cached_ = cached; dirty_ = true; }
+    [[nodiscard]] inline bool isCached() const {return cached_; }
+    inline void invalidate() {dirty_ = true; }
+
+private:
+    bool cached_ = false;
+    bool dirty_ = true;
+    std::shared_ptr<KiwiFrame> cache_;     ///< RGBA target of a cached layer, premultiplied alpha
+    friend class KiwiCore;
 };
 
 /**
@@ -479,9 +661,11 @@ public:
     void render(float windowWidth, float windowHeight, double time, double deltaTime) override;
     inline Camera2D& getCamera() override {return camera;};
     void updateMousePosition(glm::vec2 normalizedPosition) override;
+    // Input, camera, draw list, plot and scene changes; changing an object in place needs invalidate()
+    bool needsRender() override;
     // other public methods (for API)
     inline NestGrid2D& getGrid() {return grid_;};
-    inline void add(const std::shared_ptr<Object2D>& obj) {drawList.push_back(obj); }
+    inline void add(const std::shared_ptr<Object2D>& obj) {drawList.push_back(obj); invalidate(); }
     inline std::vector<std::shared_ptr<Object2D>> getItems() {return drawList; }
     inline std::shared_ptr<Object2D> getItem(int i) {return drawList[i]; }
     inline void onMouseClick(const std::function<bool(MouseEvent, KiwiLayer2D&)>& callback) { onMouseClickCallback=callback; };
@@ -490,8 +674,39 @@ public:
 
     [[maybe_unused]] inline glm::vec2 getMouseCoordinates() {return mousePosition; }
 
+    // Batching (off by default): draw the drawList through per-material streams instead of one
+    // draw per object; circles become SDF instances and objects get a per-object depth
+    inline void setBatchingEnabled(bool enabled) {batchingEnabled_ = enabled; }
+    [[nodiscard]] inline bool isBatchingEnabled() const {return batchingEnabled_; }
+    [[nodiscard]] const BatchStats2D& getBatchStats() const;
+
+    // Sorting (without batching, off by default): draw objects grouped by shader and material,
+    // order kept by a per-object depth
+    inline void setSortingEnabled(bool enabled) {sortingEnabled_ = enabled; }
+    [[nodiscard]] inline bool isSortingEnabled() const {return sortingEnabled_; }
+    [[nodiscard]] const RenderQueueStats2D& getQueueStats() const;
+
+    // Scene graph: drawn after the drawList, nodes outside the camera view are culled
+    [[nodiscard]] const std::shared_ptr<SceneNode2D>& getScene();
+    [[nodiscard]] const SceneStats2D& getSceneStats() const;
+
+    // Data plots: drawn on top of the drawList and the scene, decimated to the view
+    inline void addPlot(const std::shared_ptr<PlotSeries2D>& plot) {plots_.push_back(plot); invalidate(); }
+    void removePlot(const std::shared_ptr<PlotSeries2D>& plot);
+    // Points drawn by all plots in the last frame, after culling and decimation
+    [[nodiscard]] inline size_t getDrawnPlotPoints() const {return drawnPlotPoints_; }
+
     void registerComponent(std::shared_ptr<KiwiComponent2D> component);
     void handleMouseEvent(MouseEvent mouseEvent) override;
+
+    // Hit testing: cell size of the component grid, in layer units
+    inline void setHitTestCellSize(float cellSize) {hitTestIndex_.setCellSize(cellSize); }
+private:
+    void markComponentDirty(size_t index);
+    void refreshHitTestIndex();
+    [[nodiscard]] glm::vec4 getViewBounds() const;     // visible region in layer coordinates
+    void renderPlots(const glm::mat3& cameraTransform, glm::vec2 viewportSize);
+    friend class KiwiComponent2D;
 private:
     std::vector<std::shared_ptr<Object2D>> drawList;
     std::vector<std::shared_ptr<KiwiComponent2D>> components;    // TODO abstract to KiwiComponent
@@ -507,6 +722,24 @@ private:
     glm::vec2 prevCameraPosition{};    ///< This for canvas translation
 
     glm::vec2 mouseNormalizedPosition{};    ///< mouse position w.r.t. frame
+
+    std::shared_ptr<BatchRenderer2D> batch_;
+    bool batchingEnabled_ = false;
+
+    std::shared_ptr<RenderQueue2D> queue_;
+    bool sortingEnabled_ = false;
+
+    std::shared_ptr<SceneNode2D> scene_;
+    std::shared_ptr<SceneStats2D> sceneStats_;
+
+    std::vector<std::shared_ptr<PlotSeries2D>> plots_;
+    size_t renderedPlotPoints_ = 0;             ///< points in the plots at the last render
+    size_t drawnPlotPoints_ = 0;                ///< points drawn at the last render
+
+    SpatialGrid2D hitTestIndex_;                ///< component bounds, indexed by position in `components`
+    std::vector<size_t> dirtyComponents_;       ///< components whose bounds were invalidated
+    std::vector<size_t> activeComponents_;      ///< hovering or mouse-down components (need Leave/Release)
+    std::vector<size_t> hitCandidates_;
     friend class KiwiCore;
 };
 
@@ -518,19 +751,45 @@ private:
  */
 class KiwiFrame {
 public:
-    KiwiFrame();
+    /**
+     * @brief Backing allocations are rounded up to multiples of this many pixels.
+     */
+    static constexpr int SIZE_BUCKET = 256;
+
+    /**
+     * @param transparent RGBA color cleared to transparent black (cached layers), RGB otherwise
+     * @param depth Whether to attach a depth/stencil buffer
+     */
+    explicit KiwiFrame(bool transparent = false, bool depth = true);
     ~KiwiFrame();
+
+    /**
+     * @brief Set the active size. The backing texture only grows (in SIZE_BUCKET steps) and
+     * shrinks once the size drops below half of it, so dragging a panel does not reallocate.
+     */
     void resize(int width, int height);
+    void setDepthBuffer(bool depth);
     [[nodiscard]] inline glm::vec2 size() const {return frameSize; }
-    void bind() const;
+    [[nodiscard]] inline glm::vec2 allocatedSize() const {return allocatedSize_; }
+    /**
+     * @brief Texture coordinates of the top right corner of the active area (bottom left is 0,0).
+     */
+    [[nodiscard]] inline glm::vec2 getUVScale() const {return frameSize / allocatedSize_; }
+    void bind(bool clear = true) const;
     static void unbind() ;
     [[nodiscard]] inline void *getTextureId() const { return reinterpret_cast<void *>(textureId); }
+    [[nodiscard]] inline unsigned int getTexture() const { return textureId; }
+    [[nodiscard]] inline unsigned int getFramebuffer() const { return frameBufferObject; }
     [[maybe_unused]] void saveFrameAsImage(const std::string& filename);
 private:
-    glm::vec2 frameSize = {1280, 920};
+    void allocate(int width, int height);
+
+    bool transparent_;
+    glm::vec2 frameSize = {1280, 920};  // active area, drawn at the bottom left of the texture
+    glm::vec2 allocatedSize_{};
     unsigned int textureId{};
     unsigned int frameBufferObject{};   // color values
-    unsigned int renderBufferObject{};  // depth values
+    unsigned int renderBufferObject{};  // depth values, 0 without depth buffer
 };
 
 /**
@@ -560,14 +819,50 @@ struct KiwiState {
 class KiwiCore {
 public:
     KiwiCore();
-    ~KiwiCore() = default;
+    ~KiwiCore();
     void pollEvents(glm::vec2 windowPos, glm::vec2 mousePos, InputState inputState);
+    /**
+     * @brief Late latching: move the mouse of the layers to a newer position right before the
+     * frame is rendered (same coordinates as pollEvents(), no button or wheel events).
+     */
+    void latchMousePosition(glm::vec2 windowPos, glm::vec2 mousePos);
     void renderFrame(float windowWidth, float windowHeight, double time, double deltaTime);
-
-    [[nodiscard]] inline void *getTextureId() const { return frame.getTextureId(); }
+    /**
+     * @brief Render into the default framebuffer (fullscreen). Layers draw straight to the
+     * screen unless one is cached; then the frame is rendered and blitted.
+     */
+    void renderFrameToScreen(int width, int height, double time, double deltaTime);
+
+    /**
+     * @brief Texture of the last frame: from the render thread when it drew the frame.
+     */
+    [[nodiscard]] void *getTextureId() const;
+    /**
+     * @brief Top right texture coordinate of the rendered area in getTextureId().
+     */
+    [[nodiscard]] glm::vec2 getTextureUVScale() const;
+
+    /**
+     * @brief Whether a layer changed since the last frame (an idle UI skips rendering otherwise).
+     */
+    [[nodiscard]] virtual bool needsRender() const;
+
+    /**
+     * @brief Hand a frame to the render thread without taking a finished one, the texture
+     * stays the one of the last renderFrame().
+     * @return false if the frame cannot be drawn on the render thread (see setRenderThread)
+     */
+    bool submitFrame(float windowWidth, float windowHeight, double time, double deltaTime);
+
+    /**
+     * @brief Draw frames on a render thread while it runs (nullptr: always on the calling thread).
+     * Frames fall back to the calling thread while a layer does not support it or is cached.
+     */
+    inline void setRenderThread(RenderThread* thread) { renderThread_ = thread; }
+    [[nodiscard]] inline RenderThread* getRenderThread() const { return renderThread_; }
 public:
 
-    [[nodiscard]] inline glm::vec2 frameSize() const {return frame.size(); }
+    [[nodiscard]] inline glm::vec2 frameSize() const {return viewSize_; }
 public: // API overrides
     virtual void onLoad() = 0;
     virtual void onUpdate(float time, float deltaTime) = 0;
@@ -576,13 +871,26 @@ public: // API overrides
     virtual void onMouseButton(int button, int action, double x, double y, GLFWwindow* window) { /* Default: do nothing */ }
     virtual void onMouseMove(double x, double y) { /* Default: do nothing */ }
     virtual void onMouseScroll(double yOffset) { /* Default: do nothing */ }
+    /**
+     * @brief Called at the end of renderFrame(), once getTextureId() holds the new frame
+     * (extra passes that read it, e.g. comparison views).
+     */
+    virtual void onRender(float width, float height, double time, double deltaTime) { /* Default: do nothing */ }
 public:
     KIWI_API void addLayer(std::shared_ptr<KiwiLayer> layer);
 private:
     void calcNormalizedMousePos(glm::vec2 windowPos, glm::vec2 mousePos);
+    void setViewSize(float width, float height);
+    bool submitToRenderThread(float width, float height, double time, double deltaTime);
+    void renderCachedLayer(KiwiLayer& layer, float width, float height, double time, double deltaTime);
 
 protected:
     KiwiFrame frame;
+    glm::vec2 viewSize_;                        ///< size of the last rendered frame, in the FBO or on screen
+    RenderThread* renderThread_ = nullptr;
+    bool threadedFrame_ = false;                ///< the last frame was drawn by the render thread
+    std::shared_ptr<Shader> compositeShader_;   ///< blends the texture of a cached layer
+    unsigned int compositeVertexArray_{};
     std::vector<std::shared_ptr<KiwiLayer>> layers;
     KiwiState state;
 };
@@ -17,6 +17,7 @@
 #include <set>
 #include <imgui.h>
 #include <chrono>
+#include <cstdint>
 
 /**
  * @brief Log severity levels
@@ -94,6 +95,11 @@ public:
     static void clear();
     static std::vector<LogMessage> getAllMessages();
     
+    /**
+     * @brief Counter bumped by every new message and clear() (the UI redraws when it changes)
+     */
+    static uint64_t getRevision();
+    
     // =========================================================================
     // Font Management
     // =========================================================================
@@ -111,6 +117,7 @@ private:
     // Log storage
     std::vector<LogMessage> messages_;
     size_t maxBufferSize_ = 1000;
+    uint64_t revision_ = 0;
     LogLevel minLogLevel_ = LogLevel::TRACE;
     
     // UI state
@@ -0,0 +1,105 @@
+/**
+ * @file ObjectPool2D.h
+ * @brief Pooled allocation of 2D objects.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-size block allocator: contiguous chunks of blocks and an intrusive free list.
+ *
+ * Freed blocks are reused before a new chunk is allocated, so building and tearing down
+ * large scenes does not go through the general-purpose heap for every object, and objects
+ * of the same size stay next to each other in memory. Not thread-safe: like the rest of
+ * the 2D renderer, objects are created and destroyed on the UI thread (the render thread
+ * only draws ShaderLayer snapshots and never touches 2D objects).
+ */
+class BlockPool2D {
+public:
+    /**
+     * @brief Blocks per chunk.
+     */
+    static constexpr size_t CHUNK_BLOCKS = 256;
+
+    explicit BlockPool2D(size_t blockSize);
+
+    // Delete copy constructor and assignment
+    BlockPool2D(const BlockPool2D&) = delete;
+    BlockPool2D& operator=(const BlockPool2D&) = delete;
+
+    void* allocate();
+    void deallocate(void* block);
+
+    [[nodiscard]] inline size_t getBlockSize() const {return blockSize_; }
+    [[nodiscard]] inline size_t getUsedBlocks() const {return usedBlocks_; }
+    [[nodiscard]] inline size_t getCapacity() const {return chunks_.size() * CHUNK_BLOCKS; }
+
+    /**
+     * @brief Shared pool for blocks of at least `size` bytes (rounded up to 16 bytes).
+     * Pools are never destroyed, so pooled objects may outlive static destruction.
+     */
+    static BlockPool2D& forSize(size_t size);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockSize_;
+    size_t usedBlocks_ = 0;
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    FreeBlock* freeList_ = nullptr;
+};
+
+/**
+ * @brief Standard allocator over BlockPool2D, single objects only go through the pool.
+ */
+template<class T>
+struct PoolAllocator2D {
+    using value_type = T;
+
+    PoolAllocator2D() = default;
+    template<class U>
+    PoolAllocator2D(const PoolAllocator2D<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n == 1 && alignof(T) <= alignof(std::max_align_t)) {
+            return static_cast<T*>(BlockPool2D::forSize(sizeof(T)).allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n == 1 && alignof(T) <= alignof(std::max_align_t)) {
+            BlockPool2D::forSize(sizeof(T)).deallocate(p);
+            return;
+        }
+        ::operator delete(p);
+    }
+
+    template<class U>
+    bool operator==(const PoolAllocator2D<U>&) const noexcept { return true; }
+};
+
+/**
+ * @brief Create a 2D object in the pool, as a drop-in for std::make_shared.
+ *
+ * The object and its reference count share one pooled block, which returns to the
+ * free list when the last reference goes away.
+ *
+ * Usage:
+ * @code
+ *   auto rect = makePooled2D<Rectangle2D>(Material::Red, Material::Black);
+ *   layer.add(rect);
+ * @endcode
+ */
+template<class T, class... Args>
+std::shared_ptr<T> makePooled2D(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator2D<T>(), std::forward<Args>(args)...);
+}
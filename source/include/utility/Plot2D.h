@@ -0,0 +1,132 @@
+/**
+ * @file Plot2D.h
+ * @brief Streaming polyline and scatter plots for large 2D datasets.
+ */
+
+#pragma once
+
+#include "utility/Layer2D.h"
+
+#include <vector>
+
+/**
+ * @brief Vertex streamed to the GPU for a visible plot point (24 bytes).
+ */
+struct PlotVertex2D {
+    glm::vec2 position;     ///< layer coordinates
+    glm::vec4 color;
+};
+
+/**
+ * @brief A data series drawn as a thick antialiased polyline or as point sprites.
+ *
+ * Points are kept on the CPU together with a min/max pyramid (per block of 2^k points).
+ * Each frame only the visible range is looked up and, when it holds more than a few
+ * points per pixel column, every column is reduced to its minimum and maximum point,
+ * which preserves the envelope of the signal. The result is written into a persistently
+ * mapped ring buffer (orphaned buffer updates without GL 4.4) and drawn with one instanced
+ * draw: each instance is a segment (or a point) expanded to a quad with a pixel-space
+ * distance function for the antialiased edge.
+ *
+ * Only lines are decimated, a scatter plot draws every visible point. Decimation needs
+ * ascending x (time series); a series that receives a smaller x than its
+ * last point is treated as an unordered point cloud and drawn in full.
+ *
+ * Usage:
+ * @code
+ *   auto plot = std::make_shared<PlotSeries2D>(PlotSeries2D::Style::Line);
+ *   for (size_t i = 0; i < samples.size(); i++) plot->append({float(i), samples[i]});
+ *   layer.addPlot(plot);
+ * @endcode
+ */
+class PlotSeries2D {
+public:
+    enum class Style {
+        Line,
+        Scatter
+    };
+
+    explicit PlotSeries2D(Style style = Style::Line);
+    ~PlotSeries2D();
+
+    // Delete copy constructor and assignment
+    PlotSeries2D(const PlotSeries2D&) = delete;
+    PlotSeries2D& operator=(const PlotSeries2D&) = delete;
+
+    // Data
+    void append(glm::vec2 point);
+    void append(glm::vec2 point, float value);      ///< value is mapped through the colormap
+    void append(const glm::vec2* points, size_t count, const float* values = nullptr);
+    void clear();
+    [[nodiscard]] inline size_t size() const {return points_.size(); }
+    [[nodiscard]] inline bool isSorted() const {return sorted_; }
+
+    // Appearance
+    inline void setStyle(Style style) {style_ = style; }
+    [[nodiscard]] inline Style getStyle() const {return style_; }
+    inline void setColor(const glm::vec4& color) {color_ = color; }
+    inline void setLineWidth(float pixels) {lineWidth_ = pixels; }
+    inline void setPointSize(float pixels) {pointSize_ = pixels; }
+    inline void setVisible(bool visible) {visible_ = visible; }
+    [[nodiscard]] inline bool isVisible() const {return visible_; }
+
+    /**
+     * @brief Color points by their value, normalized to [minValue, maxValue].
+     */
+    void setColormap(Colormap colormap, float minValue, float maxValue);
+    inline void disableColormap() {useColormap_ = false; }
+
+    /**
+     * @brief Draw the visible part of the series.
+     * @param camera Camera transformation of the layer
+     * @param inverseCamera Inverse camera transformation (normalized frame -> layer)
+     * @param viewportSize Size of the render target in pixels
+     */
+    void draw(const glm::mat3& camera, const glm::mat3& inverseCamera, glm::vec2 viewportSize);
+
+    /**
+     * @brief Number of points drawn in the last frame (after culling and decimation).
+     */
+    [[nodiscard]] inline size_t getDrawnPoints() const {return frameVertices_.size(); }
+
+private:
+    void addPoint(glm::vec2 point);
+    void collectVisible(float minX, float maxX, int columns);
+    void emitRange(size_t begin, size_t end);
+    void emitMinMax(size_t begin, size_t end);
+    void emit(size_t index);
+    size_t upload();
+
+    void createRing(size_t sectionBytes);
+    void destroyRing();
+
+    // Data and min/max pyramid: level l holds the index of the min and max y of each
+    // complete block of 2^(l+1) points
+    std::vector<glm::vec2> points_;
+    std::vector<float> values_;                     // empty until a value is appended
+    std::vector<std::vector<uint32_t>> minIndex_;
+    std::vector<std::vector<uint32_t>> maxIndex_;
+    bool sorted_ = true;
+
+    Style style_;
+    glm::vec4 color_{0.2f, 0.6f, 1.0f, 1.0f};
+    float lineWidth_ = 1.5f;
+    float pointSize_ = 4.0f;
+    bool visible_ = true;
+
+    bool useColormap_ = false;
+    Colormap colormap_ = Colormap::Viridis;
+    float minValue_ = 0.0f;
+    float maxValue_ = 1.0f;
+
+    std::vector<PlotVertex2D> frameVertices_;       // per frame, reused
+
+    // Ring buffer of RING_SECTIONS sections, one per frame in flight
+    std::shared_ptr<Shader> shader_;
+    unsigned int vertex_array_index{};
+    unsigned int vertexBuffer{};
+    void* mapped_ = nullptr;                        // persistent mapping, nullptr when orphaning
+    size_t sectionBytes_ = 0;
+    size_t section_ = 0;
+    std::vector<void*> fences_;                     // GLsync per section
+};
@@ -0,0 +1,81 @@
+/**
+ * @file QualityGovernor.h
+ * @brief Adaptive scaling of quality-annotated uniforms during interaction.
+ *
+ * Uniforms annotated with `@slider(..., quality=true)` (march steps, AO samples,
+ * shadow iterations, octaves, ...) are scaled towards their minimum while the
+ * user interacts and the GPU frame time exceeds the budget, and restored to the
+ * user's values once the view is idle.
+ */
+
+#pragma once
+
+#include <vector>
+#include "utility/UniformTypes.h"
+
+namespace Uniforms {
+
+/**
+ * @brief Controller that trades quality uniforms for frame time.
+ *
+ * The user's values are never overwritten: apply() scales them just for
+ * binding and restore() puts them back right after.
+ */
+class QualityGovernor {
+public:
+    /**
+     * @brief Advance the controller by one frame.
+     * @param gpuFrameTimeMs Last measured GPU frame time (0 if not available yet)
+     * @param interacting true while the camera moves or the mouse is held
+     * @param deltaTime Time since last frame (seconds)
+     */
+    void update(double gpuFrameTimeMs, bool interacting, double deltaTime);
+
+    /**
+     * @brief Scale quality uniforms by the current level (call before binding).
+     */
+    void apply(UniformCollection& collection);
+
+    /**
+     * @brief Restore the user's values after binding.
+     */
+    void restore(UniformCollection& collection);
+
+    /**
+     * @brief Enable/disable the governor (disabled = always full quality).
+     */
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    [[nodiscard]] bool isEnabled() const { return enabled_; }
+
+    /**
+     * @brief GPU frame time budget the governor steers towards, in milliseconds.
+     */
+    void setTargetFrameTime(float milliseconds) { targetFrameTimeMs_ = milliseconds; }
+    [[nodiscard]] float getTargetFrameTime() const { return targetFrameTimeMs_; }
+
+    /**
+     * @brief Current quality level (1 = user values, minLevel = close to annotated min).
+     */
+    [[nodiscard]] float getLevel() const { return level_; }
+
+    /**
+     * @brief Check if quality is currently reduced.
+     */
+    [[nodiscard]] bool isReducing() const { return level_ < 1.0f; }
+
+private:
+    bool enabled_ = true;
+    float targetFrameTimeMs_ = 16.0f;
+    float level_ = 1.0f;
+    float minLevel_ = 0.1f;      // Never drop below 10% of the user's range
+    float idleDelay_ = 0.3f;     // Seconds without interaction before full quality returns
+    float smoothing_ = 0.25f;    // Fraction of the correction applied per frame
+    double idleTime_ = 0.0;
+
+    // User values saved by apply(), in collection order
+    std::vector<float> savedFloats_;
+    std::vector<int> savedInts_;
+    bool applied_ = false;
+};
+
+} // namespace Uniforms
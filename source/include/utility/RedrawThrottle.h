@@ -0,0 +1,55 @@
+/**
+ * @file RedrawThrottle.h
+ * @brief Decides when the UI has to be rebuilt, so that an idle interface costs next to nothing.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Redraw scheduling of the UI.
+ *
+ * The UI is rebuilt for a few frames after each input event (hover, click and animation
+ * states of ImGui need them to settle), when a watched revision changes (log messages,
+ * status bar) and otherwise only at a low idle rate, which keeps counters shown in the
+ * UI ticking. In between, the caller only updates what changes on its own (the viewport)
+ * and shows it with the draw data of the last UI frame.
+ *
+ * Usage per iteration of the main loop:
+ * @code
+ *   throttle.watchRevision(Logger::getRevision());
+ *   if (throttle.shouldRedraw(now)) buildAndDrawUI();
+ *   else glfwWaitEventsTimeout(throttle.timeUntilRedraw(now));
+ * @endcode
+ */
+class RedrawThrottle {
+public:
+    static constexpr int SETTLE_FRAMES = 3;         ///< full frames after an event
+    static constexpr double IDLE_INTERVAL = 0.25;   ///< seconds between redraws without events
+
+    /**
+     * @brief Rebuild the UI in the next frames (input events, window changes).
+     */
+    void requestRedraw(int frames = SETTLE_FRAMES);
+
+    /**
+     * @brief Request a redraw when the revision differs from the one of the last call.
+     */
+    void watchRevision(uint64_t revision);
+
+    /**
+     * @brief Whether this frame rebuilds the UI; counts it as rebuilt if so.
+     */
+    bool shouldRedraw(double now);
+
+    /**
+     * @brief Seconds until the next idle redraw is due, 0 if a redraw is pending.
+     */
+    [[nodiscard]] double timeUntilRedraw(double now) const;
+
+private:
+    int pendingFrames_ = SETTLE_FRAMES;
+    double lastRedraw_ = 0.0;
+    uint64_t revision_ = 0;
+};
@@ -0,0 +1,104 @@
+/**
+ * @file RenderQueue2D.h
+ * @brief State-sorted submission of 2D draw lists.
+ */
+
+#pragma once
+
+#include "utility/Layer2D.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Per-frame counters of the render queue.
+ */
+struct RenderQueueStats2D {
+    size_t objects = 0;         ///< objects submitted
+    size_t groups = 0;          ///< ordered groups (separated by objects that cannot be sorted)
+    size_t materialChanges = 0; ///< material switches between consecutive draws
+    size_t shaderChanges = 0;   ///< shader switches between consecutive draws
+};
+
+/**
+ * @brief Render queue for the non-batched 2D path.
+ *
+ * Objects are collected with a 64-bit key per frame, radix-sorted and drawn so that
+ * objects sharing a shader, material and geometry follow each other; the shader and
+ * uniform caches then skip the redundant binds and uploads. Key layout, from the most
+ * significant bit:
+ *
+ *   group (16) | translucent (1) | shader (12) | material (16) | geometry (8) | depth (11)
+ *
+ * Draw order is kept where it matters:
+ *  - every object writes a per-object depth (later objects nearer) through the `depth`
+ *    uniform of the flat shader, so opaque objects may be drawn in any order with
+ *    GL_LEQUAL depth testing;
+ *  - translucent objects are drawn after the opaque ones of their group, in submission
+ *    order (the key holds their sequence number) and without depth writes;
+ *  - objects that cannot be sorted (no material, or a shader without the depth uniform)
+ *    end the current group and are drawn on their own, without depth testing.
+ *
+ * Usage per frame:
+ * @code
+ *   queue.begin();
+ *   for (auto& obj : drawList) obj->appendToQueue(queue, obj->transform);
+ *   queue.end();
+ * @endcode
+ */
+class RenderQueue2D {
+public:
+    /**
+     * @brief Start a new frame.
+     */
+    void begin();
+
+    /**
+     * @brief Queue an object.
+     * @param object Object to draw, must stay alive until end()
+     * @param model Full model transformation of the object
+     */
+    void add(Object2D& object, const glm::mat3& model);
+
+    /**
+     * @brief Sort and draw everything queued since begin().
+     */
+    void end();
+
+    [[nodiscard]] inline const RenderQueueStats2D& getStats() const { return stats_; }
+
+private:
+    struct Item {
+        Object2D* object;
+        glm::mat3 model;
+        const Material* material;       // nullptr when the object cannot be sorted
+        uint32_t sequence;
+        uint16_t group;
+        uint16_t shaderId;
+        uint16_t materialId;
+        uint8_t geometryId;
+        bool translucent;
+    };
+
+    struct Entry {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    void flush();
+    void drawItem(const Item& item, float depth);
+    uint64_t buildKey(const Item& item, size_t count) const;
+
+    std::vector<Item> items_;
+    std::vector<Entry> entries_;
+    std::vector<Entry> scratch_;
+    uint16_t group_ = 0;
+
+    // Small per-frame ids of the states found in the queue
+    std::unordered_map<const void*, uint16_t> shaderIds_;
+    std::unordered_map<const void*, uint16_t> materialIds_;
+    std::unordered_map<const void*, uint8_t> geometryIds_;     // keyed by the object's type
+
+    RenderQueueStats2D stats_;
+};
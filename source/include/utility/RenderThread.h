@@ -0,0 +1,148 @@
+/**
+ * @file RenderThread.h
+ * @brief Renders layers on their own thread and OpenGL context, decoupled from the UI.
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utility/TripleBuffer.h"
+
+struct GLFWwindow;
+class KiwiFrame;
+
+/**
+ * @brief One frame for the render thread: the size and a self-contained draw.
+ *
+ * The draw function holds copies of everything it needs (uniform values, camera,
+ * time), it must not touch state the UI thread keeps changing.
+ */
+struct RenderJob {
+    int width = 0;
+    int height = 0;
+    bool depth = false;                 ///< the target needs a depth buffer
+    std::function<void()> draw;
+};
+
+/**
+ * @brief Render thread with a context shared with the UI window.
+ *
+ * The UI thread submits a RenderJob per frame and shows the newest finished frame,
+ * so an expensive shader no longer holds menus, sliders and the log at its own rate.
+ * Jobs and finished frames cross over through lock-free triple buffers: a slow
+ * render thread just skips to the newest job, and the UI keeps showing the last
+ * finished frame until the next one is ready. Fences order the GPU work of the
+ * contexts (a frame is only sampled once rendered, and only re-rendered once every UI
+ * context, including those of undocked ImGui windows, has drawn it).
+ *
+ * Only objects shared between contexts (textures, buffers, programs) may cross over;
+ * jobs run with a scratch vertex array bound, since vertex arrays and framebuffers
+ * are per context. All functions are called from the UI thread.
+ */
+class RenderThread {
+public:
+    RenderThread();
+    ~RenderThread();
+
+    // Delete copy constructor and assignment
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * @brief Create the shared context and start the thread.
+     * @param sharedWith Window whose context shares objects with the render context
+     * @return false if the context could not be created
+     */
+    bool start(GLFWwindow* sharedWith);
+
+    /**
+     * @brief Render the last submitted job, then stop the thread and destroy its context.
+     * Call between UI frames: the finished frames are deleted.
+     */
+    void stop();
+
+    [[nodiscard]] inline bool isRunning() const { return context_ != nullptr; }
+
+    /**
+     * @brief Hand a job to the render thread (replaces a job it has not started yet).
+     */
+    void submit(RenderJob job);
+
+    /**
+     * @brief Take the newest finished frame, if any, for display in this UI frame.
+     * @return false until the first frame is finished
+     */
+    bool acquireFrame();
+
+    /**
+     * @brief Make the current context wait for the acquired frame. acquireFrame() does this
+     * for its own context; call it in every other context sampling the frame (ImGui
+     * platform windows) before their draws.
+     */
+    void waitForFrame();
+
+    /**
+     * @brief Mark the acquired frame as drawn by the current context (after its draw calls
+     * are issued). Call it in every context sampling the frame.
+     */
+    void frameDisplayed();
+
+    /**
+     * @brief Texture of the acquired frame, bottom-left origin, 0 before the first frame.
+     */
+    [[nodiscard]] unsigned int getFrameTexture();
+    /**
+     * @brief Top right texture coordinate of the rendered area in getFrameTexture().
+     */
+    [[nodiscard]] glm::vec2 getFrameUVScale();
+
+    /**
+     * @brief GPU time of the last measured render-thread frame, in milliseconds.
+     */
+    [[nodiscard]] inline double getGpuFrameTime() const { return gpuFrameTime_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Frames finished by the render thread since start(); each one also posts an empty
+     * GLFW event, so a UI waiting for events wakes up for it.
+     */
+    [[nodiscard]] inline uint64_t getRenderedFrames() const { return renderedFrames_.load(std::memory_order_relaxed); }
+
+private:
+    struct FrameSlot {
+        std::unique_ptr<KiwiFrame> frame;   // framebuffer of the render context, shared texture
+        GLsync rendered = nullptr;          // render thread: drawing finished
+        // UI thread: last draw sampling the texture, one fence per UI context
+        std::vector<std::pair<GLFWwindow*, GLsync>> displayed;
+    };
+
+    void run();
+    void renderJob(RenderJob& job);
+    void measureGpuTime();
+
+    GLFWwindow* context_ = nullptr;     // hidden window owning the render context
+    std::thread thread_;
+
+    TripleBuffer<RenderJob> jobs_;
+    TripleBuffer<FrameSlot> frames_;
+    std::atomic<uint64_t> submittedJobs_{0};
+    std::atomic<bool> stopRequested_{false};
+
+    // Render context only
+    GLuint vertexArray_ = 0;
+    GLuint gpuTimerQueries_[2] = {0, 0};    // double-buffered to avoid stalls
+    int currentQuery_ = 0;
+    bool queryPending_[2] = {false, false};
+
+    std::atomic<double> gpuFrameTime_{0.0};
+    std::atomic<uint64_t> renderedFrames_{0};
+};
@@ -0,0 +1,84 @@
+/**
+ * @file ScalarFieldLayer2D.h
+ * @brief 2D layer displaying a float field through a GPU colormap.
+ */
+
+#pragma once
+
+#include "utility/Layer2D.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A KiwiLayer2D whose background is a colormapped scalar field.
+ *
+ * The field is uploaded once as an R32F texture; normalization (linear or
+ * logarithmic), the colormap lookup (ColormapTextures) and NaN masking all
+ * happen in the fragment shader, so changing the range or the colormap costs
+ * nothing on the CPU. The field is placed on a rectangle in layer coordinates
+ * and pans/zooms with the camera; grid, objects and plots are drawn on top.
+ */
+class ScalarFieldLayer2D : public KiwiLayer2D {
+public:
+    ScalarFieldLayer2D();
+    ~ScalarFieldLayer2D() override;
+
+    void render(float windowWidth, float windowHeight, double time, double deltaTime) override;
+
+    /**
+     * @brief Upload a row-major field (row 0 at the bottom).
+     * Reuses the texture storage when the size is unchanged.
+     * @return false if the size exceeds the texture limits
+     */
+    bool setData(const float* values, int width, int height);
+
+    /**
+     * @brief Load a 2D float32/float64 array from a NumPy .npy file (C order).
+     */
+    bool loadNpy(const std::string& path);
+
+    /**
+     * @brief Load raw little-endian float32 values of a known size.
+     */
+    bool loadRaw(const std::string& path, int width, int height);
+
+    /**
+     * @brief Set the value range mapped to [0, 1] of the colormap.
+     */
+    void setRange(float minValue, float maxValue);
+
+    /**
+     * @brief Set the range to the finite min/max of the last uploaded data.
+     */
+    void fitRange();
+    [[nodiscard]] inline glm::vec2 getRange() const {return range_; }
+
+    inline void setLogScale(bool logScale) {logScale_ = logScale; invalidate(); }
+    [[nodiscard]] inline bool isLogScale() const {return logScale_; }
+    inline void setColormap(Colormap colormap) {colormap_ = colormap; invalidate(); }
+    [[nodiscard]] inline Colormap getColormap() const {return colormap_; }
+    void setInterpolation(bool linear);
+
+    /**
+     * @brief Rectangle covered by the field in layer coordinates (minX, minY, maxX, maxY).
+     */
+    inline void setExtent(const glm::vec4& extent) {extent_ = extent; invalidate(); }
+    [[nodiscard]] inline const glm::vec4& getExtent() const {return extent_; }
+
+    [[nodiscard]] inline glm::ivec2 getSize() const {return size_; }
+
+private:
+    std::shared_ptr<Shader> shader_;
+    unsigned int vertex_array_index{};
+    unsigned int fieldTexture{};
+
+    glm::ivec2 size_{0, 0};
+    glm::vec2 dataRange_{0.0f, 1.0f};   // finite min/max of the last upload
+    float dataMinPositive_ = 1.0f;      // smallest positive value, lower bound of a log range
+    glm::vec2 range_{0.0f, 1.0f};
+    glm::vec4 extent_{-1.0f, -1.0f, 1.0f, 1.0f};
+    Colormap colormap_ = Colormap::Viridis;
+    bool logScale_ = false;
+    bool linear_ = false;
+};
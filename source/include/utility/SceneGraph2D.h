@@ -0,0 +1,107 @@
+/**
+ * @file SceneGraph2D.h
+ * @brief Retained 2D scene graph with cached world transforms and bounds.
+ */
+
+#pragma once
+
+#include "utility/Layer2D.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Counters of the last scene traversal.
+ */
+struct SceneStats2D {
+    size_t drawn = 0;       ///< objects submitted for drawing
+    size_t culled = 0;      ///< objects skipped because they are outside the view
+};
+
+/**
+ * @brief A node of the 2D scene graph.
+ *
+ * Each node has a local transform, attached objects and child nodes. The world transform
+ * (parent world * local) and the world AABB of the node and of its subtree are cached and
+ * only recomputed along dirty paths: changing a node marks it dirty and flags its ancestors,
+ * so update() skips every untouched subtree.
+ *
+ * Attached objects are drawn with `world * object->transform`. Changing an attached object's
+ * transform directly requires invalidate() on its node.
+ */
+class SceneNode2D {
+public:
+    SceneNode2D() = default;
+
+    // Children hold a raw pointer to their parent
+    SceneNode2D(const SceneNode2D&) = delete;
+    SceneNode2D& operator=(const SceneNode2D&) = delete;
+
+    // Hierarchy
+    std::shared_ptr<SceneNode2D> createChild();
+    void addChild(const std::shared_ptr<SceneNode2D>& child);
+    void removeChild(const std::shared_ptr<SceneNode2D>& child);
+    [[nodiscard]] inline const std::vector<std::shared_ptr<SceneNode2D>>& getChildren() const {return children_; }
+    [[nodiscard]] inline SceneNode2D* getParent() const {return parent_; }
+
+    // Attached objects
+    void attach(const std::shared_ptr<Object2D>& object);
+    void detach(const std::shared_ptr<Object2D>& object);
+    [[nodiscard]] inline const std::vector<std::shared_ptr<Object2D>>& getObjects() const {return objects_; }
+
+    // Transform
+    void setTransform(const glm::mat3& local);
+    [[nodiscard]] inline const glm::mat3& getTransform() const {return local_; }
+    [[nodiscard]] inline const glm::mat3& getWorldTransform() const {return world_; }   ///< valid after update()
+
+    // Bounds (minX, minY, maxX, maxY) in world space, valid after update()
+    [[nodiscard]] inline const glm::vec4& getWorldBounds() const {return subtreeBounds_; }
+
+    inline void setVisible(bool visible) {visible_ = visible; }
+    [[nodiscard]] inline bool isVisible() const {return visible_; }
+
+    /**
+     * @brief Mark this node dirty (e.g. after changing an attached object's transform).
+     */
+    void invalidate();
+
+    /**
+     * @brief Whether something in the subtree changed since the last update().
+     */
+    [[nodiscard]] inline bool needsUpdate() const {return dirty_ || childDirty_; }
+
+    /**
+     * @brief Recompute world transforms and bounds of the dirty parts of the subtree.
+     * Call on the root once per frame before traverse().
+     */
+    void update();
+
+    /**
+     * @brief Visit the objects whose world bounds intersect the view.
+     * @param view Visible region in world space (minX, minY, maxX, maxY)
+     * @param visitor Called with each visible object and its full model transform
+     * @param stats Accumulates drawn/culled counts
+     */
+    void traverse(const glm::vec4& view, const std::function<void(Object2D&, const glm::mat3&)>& visitor,
+                  SceneStats2D& stats) const;
+
+private:
+    void update(const glm::mat3& parentWorld, bool parentChanged);
+    void flagAncestors();
+
+    SceneNode2D* parent_ = nullptr;
+    std::vector<std::shared_ptr<SceneNode2D>> children_;
+    std::vector<std::shared_ptr<Object2D>> objects_;
+    std::vector<glm::vec4> objectBounds_;       ///< world AABB per attached object
+
+    glm::mat3 local_{1.0f};
+    glm::mat3 world_{1.0f};
+    glm::vec4 ownBounds_{0.0f};                 ///< union of objectBounds_
+    glm::vec4 subtreeBounds_{0.0f};             ///< ownBounds_ and all children
+    size_t subtreeObjects_ = 0;                 ///< objects attached here and below, for culling stats
+
+    bool dirty_ = true;                         ///< own transform or objects changed
+    bool childDirty_ = false;                   ///< something below changed
+    bool visible_ = true;
+};
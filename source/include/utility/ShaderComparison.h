@@ -0,0 +1,115 @@
+/**
+ * @file ShaderComparison.h
+ * @brief A/B comparison of shader variants next to the main viewport.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "utility/Layer2D.h"
+#include "utility/ShaderLayer.h"
+
+class Shader;
+
+/**
+ * @brief Renders variants of a shader side by side with the main viewport (view A).
+ *
+ * Each added view (B, C, ...) owns a ShaderLayer and a frame of the viewport's size and
+ * follows the inputs of the reference layer: mouse, camera and, while linked, the values
+ * of uniforms with the same name and type. Includes are read once for all views through
+ * the preprocessor's shared cache. GPU times are shown side by side, and the difference
+ * view shows |A - X| of one view, scaled by a gain.
+ *
+ * render() is called once per viewport frame (KiwiCore::onRender) on the UI thread.
+ * With the render thread on, view A may be one frame behind the other views.
+ *
+ * Usage:
+ * @code
+ *   ShaderComparison comparison(shaderLayer);
+ *   comparison.addView("shaders/plasma_fast.frag");
+ *   // onRender():   comparison.render(width, height, time, deltaTime, texture, uvScale);
+ *   // onUpdateUI(): comparison.drawWindows();
+ * @endcode
+ */
+class ShaderComparison {
+public:
+    static constexpr size_t MAX_VIEWS = 3;      ///< views besides the reference
+
+    explicit ShaderComparison(std::shared_ptr<ShaderLayer> reference);
+    ~ShaderComparison();
+
+    /**
+     * @brief Add a view rendering the given fragment shader.
+     * @return false if all views are in use or the file does not exist
+     */
+    bool addView(const std::string& fragmentPath);
+
+    /**
+     * @brief Remove a view; its frame is released at the start of the next drawWindows().
+     */
+    void removeView(size_t index);
+    [[nodiscard]] inline size_t getViewCount() const { return views_.size(); }
+
+    /**
+     * @brief Copy the uniform values of the reference to the views every frame.
+     */
+    void setLinkUniforms(bool link);
+    [[nodiscard]] inline bool areUniformsLinked() const { return linkUniforms_; }
+
+    /**
+     * @brief Whether a view changed since its last frame (see ShaderLayer::needsRender()).
+     */
+    bool needsRender();
+
+    /**
+     * @brief Render all views at the size of the reference frame, then the difference view.
+     * @param referenceTexture Texture of view A
+     * @param referenceUVScale Top right texture coordinate of the rendered area of view A
+     */
+    void render(float width, float height, double time, double deltaTime,
+                unsigned int referenceTexture, glm::vec2 referenceUVScale);
+
+    /**
+     * @brief Draw one window per view and the "Comparison" window.
+     */
+    void drawWindows();
+
+private:
+    struct View {
+        std::string name;                       // "B", "C", ...
+        std::shared_ptr<ShaderLayer> layer;
+        std::unique_ptr<KiwiFrame> frame;
+        double gpuTime = 0.0;                   // smoothed, in milliseconds
+        bool open = true;                       // false: removed at the next drawWindows()
+    };
+
+    void renderDifference(const View& view);
+    void drawView(View& view);
+    void drawComparisonWindow();
+    static void drawFrame(const KiwiFrame& frame, glm::vec2 frameSize);
+    [[nodiscard]] std::string nextViewName() const;
+
+    std::shared_ptr<ShaderLayer> reference_;
+    std::vector<View> views_;
+    bool linkUniforms_ = true;
+    double referenceGpuTime_ = 0.0;             // smoothed, in milliseconds
+    glm::vec2 frameSize_{0.0f};
+
+    // Texture of view A in the last render()
+    unsigned int referenceTexture_ = 0;
+    glm::vec2 referenceUVScale_{1.0f};
+
+    // Difference view: |A - X| * gain
+    std::string differenceView_;                // name of the view, empty: off
+    float differenceGain_ = 4.0f;
+    std::unique_ptr<Shader> differenceShader_;
+    unsigned int differenceVertexArray_ = 0;
+    std::unique_ptr<KiwiFrame> differenceFrame_;
+
+    char pathBuffer_[512] = "";
+};
@@ -15,6 +15,10 @@
 #include <memory>
 #include <filesystem>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -24,6 +28,8 @@
 #include "utility/UniformParser.h"
 #include "utility/UniformEditor.h"
 #include "utility/CameraController.h"
+#include "utility/CostHeatmap.h"
+#include "utility/QualityGovernor.h"
 
 /**
  * @brief Result of a shader compilation attempt.
@@ -32,6 +38,66 @@ struct ShaderCompileResult {
     bool success = false;
     std::string errorLog;
     unsigned int programId = 0;
+    double compileMs = 0.0;  // Time spent in (or waiting for) the driver compile
+    double linkMs = 0.0;     // Time spent in (or waiting for) the driver link
+};
+
+/**
+ * @brief Per-stage cost of one loadShader() call, in milliseconds.
+ *
+ * Measured with std::chrono::steady_clock. With parallel compilation the
+ * driver compiles and links in one go, so compileMs also includes the frames
+ * the program spent in flight.
+ */
+struct ReloadTiming {
+    double preprocessMs = 0.0;
+    double compileMs = 0.0;
+    double linkMs = 0.0;
+    double parseMs = 0.0;
+    double locationsMs = 0.0;
+    double totalMs = 0.0;
+    bool success = false;
+};
+
+/**
+ * @brief A program whose compile and link were submitted but not yet checked.
+ *
+ * With KHR/ARB_parallel_shader_compile the driver compiles on its own threads,
+ * so the slot is polled with GL_COMPLETION_STATUS_KHR instead of blocking on
+ * GL_COMPILE_STATUS. Several slots can be in flight at once.
+ */
+struct PendingProgram {
+    unsigned int programId = 0;
+    unsigned int vertexShader = 0;
+    unsigned int fragmentShader = 0;
+    std::function<void(const ShaderCompileResult&)> onComplete;
+
+    // Cost of the submitting GL calls, and when the driver took over
+    double compileMs = 0.0;
+    double linkMs = 0.0;
+    std::chrono::steady_clock::time_point submitTime;
+};
+
+/**
+ * @brief A program derived from the current shader (cost heatmap, depth prepass).
+ */
+struct ShaderVariant {
+    unsigned int programId = 0;
+    std::vector<int> uniformLocations;  // Locations of the annotated uniforms in this program
+};
+
+/**
+ * @brief Copy of everything one frame of a ShaderLayer draws with, for the render thread.
+ */
+struct ShaderFrameSnapshot {
+    std::shared_ptr<const unsigned int> program;    // keeps the program alive until the frame is drawn
+    unsigned int quadBuffer = 0;
+    glm::vec2 resolution{1.0f, 1.0f};
+    double time = 0.0;
+    double deltaTime = 0.0;
+    glm::vec4 mouse{0.0f};                          // iMouse, in pixels
+    Uniforms::UniformCollection uniforms;           // values with the quality governor applied
+    CameraController camera;
 };
 
 /**
@@ -69,10 +135,43 @@ public:
     void updateMousePosition(glm::vec2 normalizedPosition) override;
     void handleMouseEvent(MouseEvent mouseEvent) override;
 
+    /**
+     * @brief Whether the cached image is out of date (see KiwiLayer::setCached()).
+     *
+     * True every frame for shaders reading iTime/iTimeDelta/iFrame/iDate, while the
+     * camera moves, the quality governor adapts, a compile is in flight or the cost
+     * heatmap is shown; otherwise only after input the shader reads (iMouse), a reload
+     * or invalidate() (call it after editing uniform values).
+     */
+    bool needsRender() override;
+
+    /**
+     * @brief Fullscreen fragment shader only: the frame can skip its depth buffer.
+     */
+    [[nodiscard]] bool needsDepthBuffer() const override { return false; }
+
+    /**
+     * @brief The shader can be drawn on the render thread, except while the cost heatmap or
+     * the depth prepass is on (their framebuffers belong to the UI context).
+     */
+    [[nodiscard]] bool supportsRenderThread() const override;
+
+    /**
+     * @brief Poll compiles and reloads and run the quality governor like render(), then
+     * capture a ShaderFrameSnapshot that the render thread draws.
+     */
+    std::function<void()> captureRenderJob(const RenderThread& thread, float windowWidth, float windowHeight,
+                                           double time, double deltaTime) override;
+
     /**
      * @brief Load a fragment shader from file.
+     *
+     * When the driver supports parallel shader compilation the compile is only
+     * submitted here; the previous program keeps rendering until the new one
+     * finishes (see isCompiling() and onCompileFinished()).
+     *
      * @param fragmentPath Path to the fragment shader file.
-     * @return true if compilation succeeded, false otherwise.
+     * @return true if compilation succeeded or was submitted, false otherwise.
      */
     bool loadShader(const std::string& fragmentPath);
 
@@ -98,6 +197,22 @@ public:
      */
     [[nodiscard]] bool hasValidShader() const { return shaderProgram_ != 0; }
 
+    /**
+     * @brief Check if a shader compile is still running inside the driver.
+     */
+    [[nodiscard]] bool isCompiling() const { return !pendingPrograms_.empty(); }
+
+    /**
+     * @brief Check if the driver exposes KHR/ARB_parallel_shader_compile.
+     */
+    [[nodiscard]] bool isParallelCompileSupported() const { return parallelCompile_; }
+
+    /**
+     * @brief Register a callback invoked when a loadShader() compile finishes.
+     * @param callback Receives true on success, false on a compile/link error.
+     */
+    inline void onCompileFinished(const std::function<void(bool)>& callback) { onCompileFinishedCallback_ = callback; }
+
     /**
      * @brief Get the current shader file path.
      */
@@ -146,15 +261,104 @@ public:
      */
     [[nodiscard]] double getGpuFrameTime() const { return gpuFrameTime_; }
     
+    /**
+     * @brief Get the reload timing history of the current shader (oldest first).
+     */
+    [[nodiscard]] const std::deque<ReloadTiming>& getReloadHistory() const;
+
+    /**
+     * @brief Write the reload timing history of all loaded shaders as JSON.
+     * @param path Output file path.
+     * @return true if the file was written.
+     */
+    bool saveReloadHistory(const std::string& path) const;
+
+    /**
+     * @brief Show per-pixel loop cost instead of the shader's output.
+     *
+     * Compiles a variant instrumented at `// @costloop` loops (see
+     * ShaderPreprocessor::instrumentCostLoops) and renders it through CostHeatmap.
+     */
+    void setCostHeatmapEnabled(bool enabled);
+    [[nodiscard]] bool isCostHeatmapEnabled() const { return costHeatmapEnabled_; }
+
+    /**
+     * @brief Get the cost heatmap (colormap selection and min/max/mean readouts).
+     */
+    CostHeatmap& getCostHeatmap() { return costHeatmap_; }
+    const CostHeatmap& getCostHeatmap() const { return costHeatmap_; }
+
+    /**
+     * @brief Enable the cone-marched depth prepass.
+     *
+     * Shaders opt in by handling `#ifdef KIWI_DEPTH_PREPASS` (write a safe start
+     * distance to fragColor.r) and reading it back with depthPrepassStart() from
+     * sdf/operations.glsl. The prepass runs at 1/downscale resolution into an
+     * R32F texture bound as `iDepthPrepass`.
+     */
+    void setDepthPrepassEnabled(bool enabled);
+    [[nodiscard]] bool isDepthPrepassEnabled() const { return depthPrepassEnabled_; }
+
+    /**
+     * @brief Set the prepass resolution divisor (4 or 8).
+     */
+    void setDepthPrepassDownscale(int downscale) { depthPrepassDownscale_ = downscale; invalidate(); }
+    [[nodiscard]] int getDepthPrepassDownscale() const { return depthPrepassDownscale_; }
+
+    /**
+     * @brief Check if the current shader has a KIWI_DEPTH_PREPASS path.
+     */
+    [[nodiscard]] bool supportsDepthPrepass() const { return shaderSource_.find("KIWI_DEPTH_PREPASS") != std::string::npos; }
+
+    /**
+     * @brief Get the governor that lowers `quality=true` uniforms during interaction.
+     */
+    Uniforms::QualityGovernor& getQualityGovernor() { return qualityGovernor_; }
+    const Uniforms::QualityGovernor& getQualityGovernor() const { return qualityGovernor_; }
+
     /**
      * @brief Get the 3D camera controller
      */
     CameraController& getCameraController() { return cameraController_; }
     const CameraController& getCameraController() const { return cameraController_; }
 
+    /**
+     * @brief Follow the mouse and camera of another layer (nullptr: own inputs).
+     *
+     * Copied at the start of every frame, so variants of a shader compare on the same
+     * inputs. With linked uniforms, values are also copied by name and type.
+     */
+    void setInputSource(std::shared_ptr<const ShaderLayer> source) { inputSource_ = std::move(source); }
+    [[nodiscard]] const std::shared_ptr<const ShaderLayer>& getInputSource() const { return inputSource_; }
+    void setLinkUniforms(bool link) { linkUniforms_ = link; }
+    [[nodiscard]] bool areUniformsLinked() const { return linkUniforms_; }
+
 private:
     // Shader compilation
     ShaderCompileResult tryCompileShader(const std::string& vertexSrc, const std::string& fragmentSrc);
+    static PendingProgram beginCompile(const std::string& vertexSrc, const std::string& fragmentSrc);
+    static ShaderCompileResult collectProgramResult(const PendingProgram& pending);
+    void submitProgram(const std::string& vertexSrc, const std::string& fragmentSrc,
+                       std::function<void(const ShaderCompileResult&)> onComplete);
+    void pollPendingPrograms();
+    void activateProgram(const ShaderCompileResult& result, const std::string& fragmentPath,
+                         const std::string& fragmentSrc, ReloadTiming timing);
+    void recordReloadTiming(const std::string& fragmentPath, ReloadTiming timing);
+    void compileVariants();
+    void compileVariant(const std::string& source, ShaderVariant& variant, const bool& enabled, const std::string& label);
+    static void deleteVariant(ShaderVariant& variant);
+
+    // Rendering helpers
+    void beginFrame(float windowWidth, float windowHeight);
+    void followInputSource();
+    [[nodiscard]] glm::vec4 getMouseUniform() const;
+    static void bindShadertoyUniforms(unsigned int program, glm::vec2 resolution, double time, double deltaTime,
+                                      glm::vec4 mouse);
+    static void drawSnapshot(ShaderFrameSnapshot& snapshot);
+    void drawProgram(unsigned int program, std::vector<int>* variantLocations, double time, double deltaTime);
+    bool renderDepthPrepass(double time, double deltaTime);
+    void ensureDepthPrepassTarget(int width, int height);
+    bool cameraMovedSinceLastFrame();
     std::string loadFileContents(const std::string& path);
     std::filesystem::file_time_type getFileModTime(const std::string& path);
 
@@ -167,6 +371,7 @@ private:
 private:
     // OpenGL resources
     unsigned int shaderProgram_ = 0;
+    std::shared_ptr<const unsigned int> programOwner_;  // shared with frames pending on the render thread
     unsigned int quadVAO_ = 0;
     unsigned int quadVBO_ = 0;
 
@@ -177,6 +382,31 @@ private:
     std::string lastError_;
     bool autoReload_ = true;
     
+    // Parallel (driver-threaded) compilation
+    bool parallelCompile_ = false;
+    std::vector<PendingProgram> pendingPrograms_;
+    unsigned int loadGeneration_ = 0;  // Only the newest loadShader() result is activated
+    std::function<void(bool)> onCompileFinishedCallback_;
+
+    // Reload timing history, keyed by shader path
+    static constexpr size_t MAX_RELOAD_HISTORY = 64;
+    std::unordered_map<std::string, std::deque<ReloadTiming>> reloadHistory_;
+
+    // Per-pixel cost heatmap (instrumented variant of the current shader)
+    bool costHeatmapEnabled_ = false;
+    ShaderVariant costVariant_;
+    CostHeatmap costHeatmap_;
+
+    // Cone-marched depth prepass (KIWI_DEPTH_PREPASS variant of the current shader)
+    bool depthPrepassEnabled_ = false;
+    int depthPrepassDownscale_ = 4;
+    ShaderVariant prepassVariant_;
+    unsigned int prepassFramebuffer_ = 0;
+    unsigned int prepassTexture_ = 0;  // R32F safe start distances
+    int prepassWidth_ = 0;
+    int prepassHeight_ = 0;
+    bool prepassValid_ = false;        // Texture holds this frame's distances
+
     // Include file tracking for hot-reload
     std::vector<std::string> shaderDependencies_;
     std::unordered_map<std::string, std::filesystem::file_time_type> dependencyModTimes_;
@@ -187,11 +417,21 @@ private:
     // Camera (minimal implementation)
     ShaderCamera camera_;
 
+    // Inputs the current program reads, for needsRender()
+    bool usesTime_ = false;
+    bool usesMouse_ = false;
+    bool changesPolled_ = false;        // needsRender() already polled compiles and files this frame
+    Camera3DState renderedCameraState_;
+
     // Input state
     glm::vec2 mousePosition_{0.0f};
     glm::vec2 mouseClickPosition_{0.0f};
     bool mouseDown_ = false;
 
+    // Layer whose inputs are followed (A/B comparison)
+    std::shared_ptr<const ShaderLayer> inputSource_;
+    bool linkUniforms_ = true;
+
     // Resolution tracking
     glm::vec2 resolution_{1.0f, 1.0f};
     
@@ -200,6 +440,10 @@ private:
     int currentQuery_ = 0;
     double gpuFrameTime_ = 0.0;  // In milliseconds
     
+    // Adaptive quality during interaction
+    Uniforms::QualityGovernor qualityGovernor_;
+    Camera3DState lastCameraState_;
+
     // 3D camera controller
     CameraController cameraController_;
 };
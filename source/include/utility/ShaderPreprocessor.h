@@ -26,8 +26,31 @@ struct PreprocessResult {
     std::vector<std::string> dependencies;  // List of included files
 };
 
+/**
+ * @brief Result of instrumenting a shader for per-pixel cost measurement.
+ */
+struct InstrumentResult {
+    bool success = false;
+    std::string source;              // Instrumented source
+    std::string errorMessage;
+    int instrumentedLoops = 0;       // Number of @costloop loops rewritten
+};
+
+/**
+ * @brief Counters of the include cache shared by all shaders.
+ */
+struct IncludeCacheStats {
+    size_t files = 0;       // Files held in the cache
+    size_t hits = 0;        // Includes served from memory
+    size_t reads = 0;       // Includes read from disk (first use or modified)
+};
+
 /**
  * @brief Preprocessor that handles #include directives.
+ *
+ * Included files are read through a cache shared by all shaders (e.g. the
+ * viewports of an A/B comparison include the same libraries); an entry is
+ * used while the modification time of its file is unchanged.
  */
 class ShaderPreprocessor {
 public:
@@ -46,6 +69,35 @@ public:
      */
     static PreprocessResult processSource(const std::string& source, const std::string& baseDirectory);
 
+    /**
+     * @brief Rewrite loops marked with `// @costloop` to count their iterations.
+     *
+     * Each marked for/while loop increments a global counter per iteration. The
+     * original main() is renamed and called from a generated main() that writes
+     * the counter to an extra output `kiwiCostOut` (location 1).
+     *
+     * @param source Preprocessed shader source (includes already expanded)
+     * @return Instrumented source, or an error if main() could not be found
+     */
+    static InstrumentResult instrumentCostLoops(const std::string& source);
+
+    /**
+     * @brief Insert `#define name` after the #version / #extension directives.
+     * @param source Preprocessed shader source
+     * @param name Macro name to define (e.g. "KIWI_DEPTH_PREPASS")
+     */
+    static std::string addDefine(const std::string& source, const std::string& name);
+
+    /**
+     * @brief Get the counters of the shared include cache.
+     */
+    static IncludeCacheStats getIncludeCacheStats();
+
+    /**
+     * @brief Drop all cached include files (they are read again on their next use).
+     */
+    static void clearIncludeCache();
+
 private:
     std::string baseDirectory_;
     std::set<std::string> processedFiles_;  // Track to prevent circular includes
@@ -71,7 +123,7 @@ private:
     std::string resolveIncludePath(const std::string& includePath, const std::string& currentFile);
     
     /**
-     * @brief Load file contents.
+     * @brief Load file contents through the shared include cache.
      */
     std::string loadFile(const std::string& path);
     
@@ -0,0 +1,61 @@
+/**
+ * @file SpatialIndex2D.h
+ * @brief Uniform grid over axis-aligned boxes for 2D hit testing.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Uniform-grid spatial index of axis-aligned boxes.
+ *
+ * Boxes use the KiwiComponent2D::getBoundingBox() convention (minX, minY, maxX, maxY)
+ * and are identified by a caller-chosen id. Point queries only look at the cell under
+ * the point; boxes spanning too many cells are kept in a separate list that is always
+ * tested instead of being written into every cell.
+ */
+class SpatialGrid2D {
+public:
+    explicit SpatialGrid2D(float cellSize = 1.0f) : cellSize_(cellSize) {}
+
+    /**
+     * @brief Change the cell size and re-insert all boxes.
+     */
+    void setCellSize(float cellSize);
+    [[nodiscard]] inline float getCellSize() const { return cellSize_; }
+
+    /**
+     * @brief Insert or move a box. Inverted (empty) boxes are removed from the index.
+     */
+    void update(size_t id, const glm::vec4& box);
+
+    void remove(size_t id);
+    void clear();
+
+    /**
+     * @brief Append the ids of all boxes strictly containing the point to `out`.
+     */
+    void query(glm::vec2 point, std::vector<size_t>& out) const;
+
+private:
+    struct Entry {
+        glm::vec4 box{0.0f};
+        glm::ivec4 cells{0};    // covered cell range (minX, minY, maxX, maxY)
+        bool present = false;
+        bool oversized = false;
+    };
+
+    [[nodiscard]] glm::ivec2 cellOf(glm::vec2 point) const;
+    [[nodiscard]] static int64_t key(int x, int y);
+    void link(size_t id);
+    void unlink(size_t id);
+
+    float cellSize_;
+    std::vector<Entry> entries_;                                 // indexed by id
+    std::unordered_map<int64_t, std::vector<size_t>> cells_;
+    std::vector<size_t> oversized_;
+};
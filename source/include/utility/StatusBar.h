@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <functional>
 #include <vector>
@@ -93,6 +94,11 @@ public:
      */
     static constexpr float getHeight() { return HEIGHT; }
     
+    /**
+     * @brief Counter bumped by every change of state, message or widgets (the UI redraws when it changes)
+     */
+    uint64_t getRevision() const { return revision_; }
+    
 private:
     StatusBar() = default;
     ~StatusBar() = default;
@@ -100,6 +106,7 @@ private:
     StatusBarState state_ = StatusBarState::Idle;
     std::string message_ = "Ready";
     std::vector<StatusBarWidget> widgets_;
+    uint64_t revision_ = 0;
     
     static constexpr float HEIGHT = 24.0f;
 };
@@ -0,0 +1,30 @@
+/**
+ * @file Triangulate2D.h
+ * @brief Ear-clipping triangulation of simple polygons with holes.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/**
+ * @brief Triangulate a polygon with holes.
+ *
+ * Holes are bridged into the outer ring, then ears are clipped; polygons with
+ * more than 80 vertices use a z-order curve to find the vertices that can lie
+ * inside a candidate ear. Slightly self-intersecting or degenerate input still
+ * produces a best-effort triangulation instead of failing. Ported from
+ * mapbox/earcut (ISC license, see Triangulate2D.cpp).
+ *
+ * @param vertices Outer ring followed by the rings of the holes, any winding
+ * @param holeStarts Index of the first vertex of each hole, ascending
+ * @param indices Output triangles (replaced), counter-clockwise
+ */
+void triangulatePolygon2D(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts,
+                          std::vector<unsigned int>& indices);
+
+/**
+ * @brief Signed area of a ring, positive when counter-clockwise.
+ */
+[[nodiscard]] double signedArea2D(const glm::vec2* ring, size_t count);
@@ -0,0 +1,74 @@
+/**
+ * @file TripleBuffer.h
+ * @brief Lock-free hand-over of the newest value between two threads.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Single-producer/single-consumer triple buffer.
+ *
+ * The producer fills back() and publish()es it; the consumer picks up the newest
+ * published slot with update() and reads front(). Neither side ever waits for the
+ * other: values published faster than they are consumed are overwritten, only the
+ * newest one is seen. Each slot is owned by exactly one side at a time, so slots
+ * may hold resources that are reused across frames (textures, buffers).
+ *
+ * Usage:
+ * @code
+ *   // producer thread
+ *   buffer.back() = snapshot;
+ *   buffer.publish();
+ *
+ *   // consumer thread
+ *   if (buffer.update()) use(buffer.front());
+ * @endcode
+ */
+template<class T>
+class TripleBuffer {
+public:
+    /**
+     * @brief Producer: slot to fill before the next publish().
+     */
+    inline T& back() { return slots_[back_]; }
+
+    /**
+     * @brief Producer: hand back() over to the consumer and take the spare slot.
+     */
+    inline void publish() {
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+     * @brief Consumer: take the newest published slot.
+     * @return false if nothing was published since the last update() (front() is unchanged)
+     */
+    inline bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Consumer: slot taken by the last update().
+     */
+    inline T& front() { return slots_[front_]; }
+
+    /**
+     * @brief All slots, only while neither side is using the buffer (setup, teardown).
+     */
+    inline std::array<T, 3>& slots() { return slots_; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 3;
+    static constexpr uint8_t FRESH = 4;     // middle slot was published and not taken yet
+
+    std::array<T, 3> slots_{};
+    uint8_t back_ = 0;
+    std::atomic<uint8_t> middle_{1};
+    uint8_t front_ = 2;
+};
@@ -39,6 +39,14 @@ public:
      */
     static void resetToDefaults(UniformCollection& collection);
 
+    /**
+     * @brief Copy values to the uniforms of another collection with the same name and type.
+     * @param source Collection to copy from.
+     * @param target Collection to copy to; uniforms without a match keep their values.
+     * @return true if any value of target changed.
+     */
+    static bool copyValues(const UniformCollection& source, UniformCollection& target);
+
     /**
      * @brief Update uniform locations for a new shader program.
      * @param collection The collection of uniforms.
@@ -46,6 +54,22 @@ public:
      */
     static void updateLocations(UniformCollection& collection, unsigned int programId);
 
+    /**
+     * @brief Look up uniform locations in another program without touching the collection.
+     * @param collection The collection of uniforms.
+     * @param programId The OpenGL shader program ID.
+     * @return One location per uniform, in collection order.
+     */
+    static std::vector<int> queryLocations(const UniformCollection& collection, unsigned int programId);
+
+    /**
+     * @brief Bind all uniform values using locations from queryLocations().
+     *
+     * Lets variants of a shader (e.g. instrumented or prepass builds) share one
+     * collection of values while each keeps its own locations.
+     */
+    static void bindUniforms(UniformCollection& collection, unsigned int programId, std::vector<int>& locations);
+
 private:
     // Individual control renderers - return true if value changed
     static bool renderFloat(FloatUniform& u);
@@ -50,6 +50,7 @@ struct UniformBase {
  * @brief Float uniform with slider control.
  * 
  * Annotation: // @slider(min=0.0, max=1.0, default=0.5)
+ *             // @slider(min=0.0, max=1.0, default=0.5, quality=true)
  */
 struct FloatUniform : public UniformBase {
     float value = 0.0f;
@@ -57,6 +58,7 @@ struct FloatUniform : public UniformBase {
     float minValue = 0.0f;
     float maxValue = 1.0f;
     float step = 0.01f;         // Drag speed / step size
+    bool quality = false;       // quality=true: may be lowered by the QualityGovernor
     
     FloatUniform() { controlType = ControlType::Slider; }
 };
@@ -65,12 +67,14 @@ struct FloatUniform : public UniformBase {
  * @brief Integer uniform with slider control.
  * 
  * Annotation: // @slider(min=0, max=100, default=50)
+ *             // @slider(min=16, max=256, default=128, quality=true)
  */
 struct IntUniform : public UniformBase {
     int value = 0;
     int defaultValue = 0;
     int minValue = 0;
     int maxValue = 100;
+    bool quality = false;       // quality=true: may be lowered by the QualityGovernor
     
     IntUniform() { controlType = ControlType::Slider; }
 };
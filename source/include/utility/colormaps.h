@@ -3,8 +3,20 @@
 #include <array>
 
 
+/**
+ * @brief Colormaps available in ColormapTables.
+ */
+enum class Colormap {
+    Viridis,
+    Blackbody,
+    Coolwarm
+};
+
 namespace ColormapTables {
     extern unsigned char blackbody_table[512][3];
     extern unsigned char coolwarm_table[512][3];
     extern unsigned char viridis_table[512][3];
+
+    // 512-entry RGB table of a colormap
+    const unsigned char (*getTable(Colormap colormap))[3];
 }
\ No newline at end of file
@@ -8,9 +8,30 @@ void GLClearError();
 
 [[maybe_unused]] bool GLCheckError(const char *function_name, const char *file_path, int line);
 
+/**
+ * @brief Whether GL diagnostics (debug context + KHR_debug output) should be used.
+ *
+ * Defaults to on in diagnostic builds (KIWI_GL_DIAGNOSTICS, set for Debug) and off
+ * in release builds. The environment variable KIWI_GL_DEBUG=0/1 overrides it at run time.
+ * Must be decided before the context is created.
+ */
+bool GLDiagnosticsRequested();
+
+/**
+ * @brief Route KHR_debug messages (errors, performance warnings, ...) into the Logger.
+ *
+ * Requires a current debug context; logs a warning and does nothing otherwise.
+ */
+void GLInstallDebugOutput();
+
 #define ASSERT(x) if (!(x)) __debugbreak();
 
+// In release builds GL_TRY is the bare call: draining glGetError around every
+// call forces a CPU/GPU sync on many drivers. Use the KHR_debug output instead.
+#ifdef KIWI_GL_DIAGNOSTICS
 #define GL_TRY(x) GLClearError();\
     x;\
     ASSERT(GLCheckError(#x, __FILE__, __LINE__))
-
+#else
+#define GL_TRY(x) x
+#endif
@@ -5,6 +5,8 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include "utility/common.h"
@@ -23,11 +25,24 @@ static int createShader(
 
 
 // RAII for OpenGL Shader
+//
+// Uniform locations are resolved once at link time and the last uploaded value of each
+// uniform is kept, so setters only reach the driver when a value actually changes.
+// The bound program is tracked globally; code that calls glUseProgram directly must
+// call Shader::invalidateBinding() before using a Shader again.
 class Shader {
 private:
     unsigned int renderer_id;
     bool compiled = false;
     // caching for uniforms
+    struct UniformSlot {
+        int location = -1;
+        int size = 0;           // number of cached components, 0 until the first upload
+        float value[16]{};      // last uploaded value (ints stored bitwise)
+    };
+    std::unordered_map<std::string, size_t> uniformSlots;  // name -> index into slots
+    std::vector<UniformSlot> slots;
+    static unsigned int boundProgram;
 public:
     explicit Shader(const std::string &filename);
 
@@ -53,8 +68,13 @@ public:
 
     void setUniform1i(const std::string &name, int i);
 
+    // Forget the tracked program (after glUseProgram calls outside of Shader)
+    static void invalidateBinding();
+
 private:
-    [[nodiscard]] int getUniformLocation(const std::string &name) const;
+    void cacheUniformLocations();
+    UniformSlot &getUniformSlot(const std::string &name);
+    static bool storeUniformValue(UniformSlot &slot, const float *value, int size);
 
 };
 
@@ -29,9 +29,15 @@
 #include "utility/Layer2D.h"
 #include "utility/Logger.h"
 #include "utility/SettingsManager.h"
-#include "utility/FullscreenQuad.h"
 #include "utility/StatusBar.h"
 #include "utility/DragDropManager.h"
+#include "utility/ColormapBatch.h"
+#include "utility/ColormapTextures.h"
+#include "utility/GeometryRegistry2D.h"
+#include "utility/RenderThread.h"
+#include "utility/RedrawThrottle.h"
+#include "utility/FramePacer.h"
+#include "utility/LatencyProbe.h"
 
 // Global flags
 static bool should_exit = false;
@@ -46,7 +52,29 @@ static bool viewport_hovered = false; // Track if mouse is over viewport for cam
 static bool is_fullscreen = false;
 static int windowed_x = 100, windowed_y = 100;
 static int windowed_width = 1480, windowed_height = 960;
-static FullscreenQuad* fullscreenQuad = nullptr;
+static double fullscreen_entered_time = 0.0;
+
+// Fullscreen hint: shown for HINT_DURATION seconds, then faded out over HINT_FADE seconds
+static constexpr double HINT_DURATION = 3.0;
+static constexpr double HINT_FADE = 1.0;
+
+// Render thread (toggled from the menu, applied between frames)
+static bool use_render_thread = false;
+static RenderThread* platform_render_thread = nullptr;                  // waited on by undocked windows
+static void (*imgui_render_window)(ImGuiViewport*, void*) = nullptr;    // ImGui's Renderer_RenderWindow
+
+// UI redraw throttling: the UI is only rebuilt after events and changes, the viewport keeps rendering
+static bool throttle_idle_ui = true;
+static RedrawThrottle ui_redraw;
+static ImVec2 shown_viewport_size = ImVec2(0, 0);   // viewport of the last UI frame
+static void* shown_viewport_texture = nullptr;       // texture in the draw data of the last UI frame
+static uint64_t shown_rendered_frames = 0;           // render-thread frames finished before the last UI frame
+static glm::vec2 shown_viewport_origin = glm::vec2(0.0f);  // frame position passed to pollEvents()
+
+// Frame pacing and input latency (View > Frame Pacing)
+static FramePacer frame_pacer;
+static LatencyProbe latency_probe;
+static bool late_latching = true;
 
 // File to open (set by menu, processed in main loop)
 static std::string pending_file_to_open = "";
@@ -71,7 +99,121 @@ void toggleFullscreen(GLFWwindow* window) {
         // Go fullscreen
         glfwSetWindowMonitor(window, monitor, 0, 0, mode->width, mode->height, mode->refreshRate);
         is_fullscreen = true;
+        fullscreen_entered_time = glfwGetTime();
     }
+    ui_redraw.requestRedraw();
+}
+
+/**
+ * @brief Time and time step of the next shader frame, shared by all render paths
+ */
+void nextFrameTime(double& time, double& delta) {
+    static double lastTime = glfwGetTime();
+    time = glfwGetTime();
+    delta = time - lastTime;
+    lastTime = time;
+}
+
+/**
+ * @brief Late latching: take the input that arrived while the frame was built, right before it
+ * renders. Camera callbacks run once more and the shader mouse moves to the newest cursor.
+ * @param framePos Position of the rendered frame, in the coordinates of pollEvents()
+ */
+void latchInput(GLFWwindow* window, KiwiCore* app, glm::vec2 framePos) {
+    if (late_latching) {
+        glfwPollEvents();
+
+        // Desktop coordinates, like ImGui's mouse position with multi-viewports
+        double cursorX, cursorY;
+        int windowX, windowY;
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+        glfwGetWindowPos(window, &windowX, &windowY);
+        app->latchMousePosition(framePos, glm::vec2(windowX + cursorX, windowY + cursorY));
+    }
+    latency_probe.latchFrame();
+}
+
+/**
+ * @brief Show or hide the latency probe and its status bar widget
+ */
+void setLatencyProbe(bool enabled) {
+    latency_probe.setEnabled(enabled);
+    if (!enabled) {
+        StatusBar::getInstance().removeWidget("latency");
+        return;
+    }
+    StatusBar::getInstance().addWidget("latency", []() {
+        ImGui::Text("|");
+        ImGui::SameLine();
+        if (latency_probe.getSampleCount() == 0) {
+            ImGui::Text("Latency: --");
+        } else {
+            ImGui::Text("Latency: %.1f ms (max %.1f)", latency_probe.getAverageLatency(), latency_probe.getMaxLatency());
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Input to present over the last %d frames with input (%s)\nDisplay scanout not included",
+                              (int) LatencyProbe::HISTORY, FramePacer::getModeName(frame_pacer.getMode()));
+        }
+    });
+}
+
+/**
+ * @brief Renderer_RenderWindow of undocked ImGui windows. Their contexts can sample the
+ * render-thread frame too (e.g. a floating viewport), so they wait for it and fence their
+ * draws like the main window.
+ */
+void renderPlatformWindow(ImGuiViewport* viewport, void* renderArg) {
+    platform_render_thread->waitForFrame();
+    imgui_render_window(viewport, renderArg);
+    platform_render_thread->frameDisplayed();
+}
+
+/**
+ * @brief Frame without rebuilding the UI: render the viewport if a layer changed and draw
+ * the last UI frame over it again.
+ * @return whether anything was drawn (false: the screen is still up to date)
+ */
+bool renderViewportOnly(GLFWwindow* window, KiwiCore* app, int display_w, int display_h) {
+    if (!show_viewport || !shown_viewport_texture || !app->needsRender()) return false;
+
+    latchInput(window, app, shown_viewport_origin);
+    double time, delta;
+    nextFrameTime(time, delta);
+    app->onUpdate(time, delta);
+
+    // The render thread finishes the frame on its own, the UI frame after it shows it
+    if (app->submitFrame(shown_viewport_size.x, shown_viewport_size.y, time, delta)) return false;
+
+    app->renderFrame(shown_viewport_size.x, shown_viewport_size.y, time, delta);
+    if (app->getTextureId() != shown_viewport_texture) {
+        // The last UI frame shows another texture
+        ui_redraw.requestRedraw(1);
+        return false;
+    }
+
+    glViewport(0, 0, display_w, display_h);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    return true;
+}
+
+/**
+ * @brief Whether this windowed frame rebuilds the UI, see RedrawThrottle.
+ */
+bool shouldRebuildUI(const RenderThread& renderThread) {
+    // Log messages and status changes show up in the UI
+    ui_redraw.watchRevision(Logger::getRevision() + StatusBar::getInstance().getRevision());
+
+    // ImGui windows dragged out of the main window get input the callbacks below do not see,
+    // and frames of the render thread are only taken by a UI frame
+    uint64_t renderedFrames = renderThread.getRenderedFrames();
+    bool newThreadedFrame = renderThread.isRunning() && renderedFrames != shown_rendered_frames;
+    bool platformWindows = ImGui::GetPlatformIO().Viewports.Size > 1;
+    if (throttle_idle_ui && !platformWindows && !newThreadedFrame && !ui_redraw.shouldRedraw(glfwGetTime())) {
+        return false;
+    }
+    shown_rendered_frames = renderedFrames;
+    return true;
 }
 
 /**
@@ -184,15 +326,31 @@ int main() {
     
     // Store app pointer in window for callbacks
     glfwSetWindowUserPointer(window, app);
-    
-    // Initialize fullscreen quad renderer
-    fullscreenQuad = new FullscreenQuad();
-    if (!fullscreenQuad->initialize()) {
-        std::cerr << "Failed to initialize fullscreen quad renderer" << std::endl;
-    }
+
+    // Shader layers can draw on their own thread so a slow shader does not slow down the UI
+    RenderThread renderThread;
+    app->setRenderThread(&renderThread);
+    platform_render_thread = &renderThread;
+    ImGuiPlatformIO& platformIO = ImGui::GetPlatformIO();
+    imgui_render_window = platformIO.Renderer_RenderWindow;
+    platformIO.Renderer_RenderWindow = renderPlatformWindow;
+
+    // Frame pacing from the last session
+    // A stale or edited value outside the known modes falls back to vsync
+    int pacing = SettingsManager::getInstance().getInt("frame_pacing", 0);
+    bool knownPacing = pacing >= static_cast<int>(FramePacing::VSync) && pacing <= static_cast<int>(FramePacing::Adaptive);
+    frame_pacer.setMode(knownPacing ? static_cast<FramePacing>(pacing) : FramePacing::VSync);
+    frame_pacer.setTargetRate(SettingsManager::getInstance().getFloat("frame_rate_cap", 120.0f));
 
     /* Main Loop */
     while (!glfwWindowShouldClose(window) && !should_exit) {
+
+        // Start or stop the render thread outside of a frame, no frame of it is on screen then
+        if (use_render_thread != renderThread.isRunning()) {
+            if (use_render_thread) use_render_thread = renderThread.start(window);
+            else renderThread.stop();
+        }
+        frame_pacer.beginFrame();
         
         // Handle key input for fullscreen toggle (using GLFW directly for reliability)
         static bool f11_was_pressed = false;
@@ -212,44 +370,52 @@ int main() {
         // Get current framebuffer size
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
+        bool presented = true;
         
         // =====================================================================
-        // FULLSCREEN MODE: Render framebuffer directly, skip ImGui
+        // FULLSCREEN MODE: Render straight to the screen, skip ImGui
         // =====================================================================
         if (is_fullscreen) {
             // Update and render the shader at fullscreen resolution
-            double time = glfwGetTime();
-            static double lastTime = time;
-            double delta = time - lastTime;
-            lastTime = time;
+            int windowX, windowY;
+            glfwGetWindowPos(window, &windowX, &windowY);
+            latchInput(window, app, glm::vec2(windowX, windowY));
+
+            double time, delta;
+            nextFrameTime(time, delta);
             
             app->onUpdate(time, delta);
-            app->renderFrame(display_w, display_h, time, delta);
+            app->renderFrameToScreen(display_w, display_h, time, delta);
             
-            // Render the framebuffer to fullscreen using our quad renderer
-            fullscreenQuad->render((GLuint)(uintptr_t)app->getTextureId(), display_w, display_h);
+            // Render minimal ImGui overlay for hint text, no ImGui frame at all once it faded out
+            double hintAlpha = std::clamp(1.0 - (time - fullscreen_entered_time - HINT_DURATION) / HINT_FADE, 0.0, 1.0);
+            if (hintAlpha > 0.0) {
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplGlfw_NewFrame();
+                ImGui::NewFrame();
             
-            // Render minimal ImGui overlay for hint text
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
-            
-            // Transparent fullscreen overlay for hint
-            ImGuiViewport* viewport = ImGui::GetMainViewport();
-            ImGui::SetNextWindowPos(ImVec2(10, 10));
-            ImGui::SetNextWindowBgAlpha(0.3f);
-            ImGui::Begin("##fullscreen_hint", nullptr, 
-                ImGuiWindowFlags_NoDecoration | 
-                ImGuiWindowFlags_AlwaysAutoResize |
-                ImGuiWindowFlags_NoSavedSettings |
-                ImGuiWindowFlags_NoFocusOnAppearing |
-                ImGuiWindowFlags_NoNav |
-                ImGuiWindowFlags_NoMove);
-            ImGui::TextColored(ImVec4(1.0f, 1.0f, 1.0f, 0.8f), "ESC to exit fullscreen | F11 to toggle");
-            ImGui::End();
+                // Transparent fullscreen overlay for hint
+                ImGui::SetNextWindowPos(ImVec2(10, 10));
+                ImGui::SetNextWindowBgAlpha(0.3f * (float) hintAlpha);
+                ImGui::Begin("##fullscreen_hint", nullptr, 
+                    ImGuiWindowFlags_NoDecoration | 
+                    ImGuiWindowFlags_AlwaysAutoResize |
+                    ImGuiWindowFlags_NoSavedSettings |
+                    ImGuiWindowFlags_NoFocusOnAppearing |
+                    ImGuiWindowFlags_NoNav |
+                    ImGuiWindowFlags_NoMove);
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 1.0f, 0.8f * (float) hintAlpha), "ESC to exit fullscreen | F11 to toggle");
+                ImGui::End();
             
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+        }
+        // =====================================================================
+        // WINDOWED MODE, IDLE UI: Only the viewport is updated
+        // =====================================================================
+        else if (!shouldRebuildUI(renderThread)) {
+            presented = renderViewportOnly(window, app, display_w, display_h);
         }
         // =====================================================================
         // WINDOWED MODE: Normal ImGui rendering
@@ -338,6 +504,41 @@ int main() {
                         ImGui::MenuItem("Viewport", nullptr, &show_viewport);
                         ImGui::MenuItem("Logger", nullptr, &show_logger);
                         ImGui::Separator();
+                        if (ImGui::MenuItem("Benchmark Colormaps")) {
+                            // Results are written to the log
+                            ColormapBatch::benchmark();
+                            show_logger = true;
+                        }
+                        ImGui::MenuItem("Render Thread", nullptr, &use_render_thread);
+                        ImGui::MenuItem("Throttle Idle UI", nullptr, &throttle_idle_ui);
+                        if (ImGui::BeginMenu("Frame Pacing")) {
+                            for (FramePacing mode: {FramePacing::VSync, FramePacing::Uncapped,
+                                                    FramePacing::Capped, FramePacing::Adaptive}) {
+                                if (ImGui::MenuItem(FramePacer::getModeName(mode), nullptr, frame_pacer.getMode() == mode)) {
+                                    frame_pacer.setMode(mode);
+                                    SettingsManager::getInstance().setInt("frame_pacing", static_cast<int>(mode));
+                                }
+                            }
+                            float rateCap = (float) frame_pacer.getTargetRate();
+                            if (ImGui::SliderFloat("Cap (FPS)", &rateCap, 30.0f, 360.0f, "%.0f")) {
+                                frame_pacer.setTargetRate(rateCap);
+                            }
+                            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                                SettingsManager::getInstance().setFloat("frame_rate_cap", rateCap);
+                            }
+                            ImGui::Separator();
+                            ImGui::MenuItem("Late Latching", nullptr, &late_latching);
+                            bool limitQueue = frame_pacer.isFrameQueueLimited();
+                            if (ImGui::MenuItem("Limit Frame Queue", nullptr, &limitQueue)) {
+                                frame_pacer.setLimitFrameQueue(limitQueue);
+                            }
+                            bool probe = latency_probe.isEnabled();
+                            if (ImGui::MenuItem("Latency Probe", nullptr, &probe)) {
+                                setLatencyProbe(probe);
+                            }
+                            ImGui::EndMenu();
+                        }
+                        ImGui::Separator();
                         if (ImGui::MenuItem("Fullscreen", "F11")) {
                             toggleFullscreen(window);
                         }
@@ -375,17 +576,23 @@ int main() {
 
                     ImVec2 windowSize = ImGui::GetContentRegionAvail();
                     ImVec2 windowPos = ImGui::GetWindowPos();
+                    glm::vec2 framePos = glm::vec2(windowPos.x + 12-3, windowPos.y + 48 - 10);
+                    latchInput(window, app, framePos);
                     ImVec2 mousePos = ImGui::GetMousePos();
 
-                    double time = ImGui::GetTime();
-                    double delta = 1.0 / ImGui::GetIO().Framerate;
+                    double time, delta;
+                    nextFrameTime(time, delta);
 
                     app->onUpdate(time, delta);
                     app->renderFrame(windowSize.x, windowSize.y, time, delta);
-                    ImGui::Image((ImTextureID) app->getTextureId(), windowSize, ImVec2(0, 1), ImVec2(1, 0));
+                    glm::vec2 uvScale = app->getTextureUVScale();
+                    ImGui::Image((ImTextureID) app->getTextureId(), windowSize, ImVec2(0, uvScale.y), ImVec2(uvScale.x, 0));
+                    shown_viewport_size = windowSize;
+                    shown_viewport_texture = app->getTextureId();
+                    shown_viewport_origin = framePos;
 
                     app->pollEvents(
-                            glm::vec2(windowPos.x + 12-3, windowPos.y + 48 - 10),
+                            framePos,
                             glm::vec2(mousePos.x, mousePos.y),
                             getState());
 
@@ -413,6 +620,10 @@ int main() {
 
                 ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+                // The render thread may reuse the shown frame once these draws are done
+                // (platform windows fence their own draws in renderPlatformWindow)
+                renderThread.frameDisplayed();
+
                 // Handling multiple viewports
                 if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
                     GLFWwindow *backup_current_context = glfwGetCurrentContext();
@@ -424,14 +635,25 @@ int main() {
             /* END: Render ImGui and handle multiple viewports */
         }
 
-        /* Swap buffers and poll IO events */
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        /* Swap buffers and poll IO events, or sleep until an event or the next idle redraw */
+        if (presented) {
+            frame_pacer.waitForDeadline();
+            glfwSwapBuffers(window);
+            frame_pacer.endFrame();
+            latency_probe.endFrame();
+            glfwPollEvents();
+        } else {
+            glfwWaitEventsTimeout(ui_redraw.timeUntilRedraw(glfwGetTime()));
+        }
     }
 
     // Cleanup
-    delete fullscreenQuad;
-    fullscreenQuad = nullptr;
+    renderThread.stop();
+    frame_pacer.release();
+    latency_probe.release();
+    app->setRenderThread(nullptr);
+    GeometryRegistry2D::release();
+    ColormapTextures::release();
     
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -450,7 +672,8 @@ GLFWwindow *createGLFWWindow() {
     /* Initialize the library */
     if (!glfwInit()) return nullptr;
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_FALSE);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+    // A debug context costs driver-side validation, only ask for it when diagnosing
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLDiagnosticsRequested() ? GL_TRUE : GL_FALSE);
 
     /* Create a windowed mode window and its OpenGL context */
     GLFWwindow *window = glfwCreateWindow(1480, 960, "Kiwi Shader", nullptr, nullptr);
@@ -462,11 +685,12 @@ GLFWwindow *createGLFWWindow() {
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
     
-    /* Enable vsync (swap interval = 1) */
+    /* Enable vsync (swap interval = 1), the frame pacer changes it from the View menu */
     glfwSwapInterval(1);
     
     /* Set up drag-and-drop callback */
     glfwSetDropCallback(window, [](GLFWwindow* window, int count, const char** paths) {
+        ui_redraw.requestRedraw();
         std::vector<std::string> filePaths;
         filePaths.reserve(count);
         for (int i = 0; i < count; ++i) {
@@ -477,6 +701,9 @@ GLFWwindow *createGLFWWindow() {
     
     /* Set up mouse button callback for camera control */
     glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
+        ui_redraw.requestRedraw();
+        latency_probe.onInput(glfwGetTime());
+
         // Get app
         auto* app = static_cast<KiwiCore*>(glfwGetWindowUserPointer(window));
         if (!app) return;
@@ -495,6 +722,9 @@ GLFWwindow *createGLFWWindow() {
     
     /* Set up cursor position callback for camera control */
     glfwSetCursorPosCallback(window, [](GLFWwindow* window, double xpos, double ypos) {
+        ui_redraw.requestRedraw();
+        latency_probe.onInput(glfwGetTime());
+
         // Get app and forward to camera (always, for smooth dragging)
         auto* app = static_cast<KiwiCore*>(glfwGetWindowUserPointer(window));
         if (app) {
@@ -504,6 +734,9 @@ GLFWwindow *createGLFWWindow() {
     
     /* Set up scroll callback for camera control */
     glfwSetScrollCallback(window, [](GLFWwindow* window, double xoffset, double yoffset) {
+        ui_redraw.requestRedraw();
+        latency_probe.onInput(glfwGetTime());
+
         // Only forward to camera if viewport is hovered
         if (!viewport_hovered) return;
         
@@ -514,6 +747,17 @@ GLFWwindow *createGLFWWindow() {
         }
     });
 
+    /* Remaining input and window events only rebuild the idle UI (ImGui chains its own callbacks after these) */
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) {
+        ui_redraw.requestRedraw();
+        latency_probe.onInput(glfwGetTime());
+    });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { ui_redraw.requestRedraw(); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { ui_redraw.requestRedraw(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { ui_redraw.requestRedraw(); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { ui_redraw.requestRedraw(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { ui_redraw.requestRedraw(); });
+
     return window;
 }
 
@@ -527,6 +771,10 @@ void initializeOpenGL(bool depthTest, bool cullFace, bool blend) {
     } else std::cout << "GLEW OK" << std::endl;
     std::cout << "GL Version : " << glGetString(GL_VERSION) << std::endl;
 
+    if (GLDiagnosticsRequested()) {
+        GLInstallDebugOutput();
+    }
+
     // Set OpenGL state
     if (depthTest) {
         glEnable(GL_DEPTH_TEST);
@@ -8,6 +8,7 @@
 
 #include "utility/Layer2D.h"
 #include "utility/ShaderLayer.h"
+#include "utility/ShaderComparison.h"
 #include "utility/UniformEditor.h"
 #include "utility/Logger.h"
 #include "utility/SettingsManager.h"
@@ -33,6 +34,9 @@ class ShaderTest : public KiwiCore {
     bool showShaderParameters = true;
     bool showProject = true;
 
+    // A/B comparison views (nullptr while off)
+    std::unique_ptr<ShaderComparison> comparison;
+
     void onLoad() override {
         addLayer(shaderLayer);
         
@@ -63,6 +67,9 @@ class ShaderTest : public KiwiCore {
             Logger::Info("ShaderTest", "Loading default shader", {"app", "shader"});
         }
         
+        // Refresh the status bar whenever a (possibly driver-threaded) compile lands
+        shaderLayer->onCompileFinished([this](bool) { updateShaderStatus(); });
+
         // Load the shader
         shaderLayer->loadShader(shaderPathBuffer);
         
@@ -222,6 +229,17 @@ class ShaderTest : public KiwiCore {
         shaderLayer->getCameraController().onMouseScroll(yOffset);
     }
 
+    void onRender(float width, float height, double time, double deltaTime) override {
+        if (!comparison) return;
+        auto texture = static_cast<unsigned int>(reinterpret_cast<uintptr_t>(getTextureId()));
+        comparison->render(width, height, time, deltaTime, texture, getTextureUVScale());
+    }
+
+    [[nodiscard]] bool needsRender() const override {
+        bool viewsChanged = comparison && comparison->needsRender();
+        return KiwiCore::needsRender() || viewsChanged;
+    }
+
     void loadShaderFromMenu(const std::string& path) override {
         strncpy(shaderPathBuffer, path.c_str(), sizeof(shaderPathBuffer) - 1);
         shaderPathBuffer[sizeof(shaderPathBuffer) - 1] = '\0';
@@ -254,7 +272,11 @@ class ShaderTest : public KiwiCore {
     }
     
     void updateShaderStatus() {
-        if (shaderLayer->hasValidShader()) {
+        if (shaderLayer->isCompiling()) {
+            std::filesystem::path shaderPath(shaderLayer->getShaderPath());
+            StatusBar::getInstance().setState(StatusBarState::Compiling);
+            StatusBar::getInstance().setMessage("Compiling: " + shaderPath.filename().string());
+        } else if (shaderLayer->hasValidShader()) {
             std::filesystem::path shaderPath(shaderLayer->getShaderPath());
             StatusBar::getInstance().setState(StatusBarState::Success);
             StatusBar::getInstance().setMessage("Shader: " + shaderPath.filename().string());
@@ -327,6 +349,65 @@ class ShaderTest : public KiwiCore {
                 if (!uniforms.empty()) {
                     ImGui::Checkbox("Show Shader Parameters", &showShaderParameters);
                 }
+                
+                // Per-pixel cost of loops marked with // @costloop
+                bool costHeatmap = shaderLayer->isCostHeatmapEnabled();
+                if (ImGui::Checkbox("Cost Heatmap", &costHeatmap)) {
+                    shaderLayer->setCostHeatmapEnabled(costHeatmap);
+                }
+                if (costHeatmap) {
+                    auto& heatmap = shaderLayer->getCostHeatmap();
+                    int colormap = static_cast<int>(heatmap.getColormap());
+                    const char* colormaps[] = {"Viridis", "Blackbody"};
+                    if (ImGui::Combo("Colormap", &colormap, colormaps, 2)) {
+                        heatmap.setColormap(static_cast<HeatmapColormap>(colormap));
+                    }
+                    const CostStats& stats = heatmap.getStats();
+                    ImGui::Text("Iterations  min: %.0f  max: %.0f  mean: %.1f", stats.min, stats.max, stats.mean);
+                }
+                
+                // Coarse cone-marched pass that gives each ray a safe start distance
+                bool depthPrepass = shaderLayer->isDepthPrepassEnabled();
+                if (ImGui::Checkbox("Depth Prepass", &depthPrepass)) {
+                    shaderLayer->setDepthPrepassEnabled(depthPrepass);
+                }
+                if (depthPrepass) {
+                    if (!shaderLayer->supportsDepthPrepass()) {
+                        ImGui::TextDisabled("Shader has no KIWI_DEPTH_PREPASS path");
+                    }
+                    int downscale = shaderLayer->getDepthPrepassDownscale() == 8 ? 1 : 0;
+                    const char* downscales[] = {"1/4 resolution", "1/8 resolution"};
+                    if (ImGui::Combo("Prepass Size", &downscale, downscales, 2)) {
+                        shaderLayer->setDepthPrepassDownscale(downscale == 1 ? 8 : 4);
+                    }
+                }
+                
+                // Lowers @slider(..., quality=true) uniforms while navigating
+                auto& governor = shaderLayer->getQualityGovernor();
+                bool adaptiveQuality = governor.isEnabled();
+                if (ImGui::Checkbox("Adaptive Quality", &adaptiveQuality)) {
+                    governor.setEnabled(adaptiveQuality);
+                }
+                if (adaptiveQuality) {
+                    float target = governor.getTargetFrameTime();
+                    if (ImGui::SliderFloat("Target GPU (ms)", &target, 4.0f, 50.0f, "%.1f")) {
+                        governor.setTargetFrameTime(target);
+                    }
+                    ImGui::Text("Quality Level: %.0f%%%s", governor.getLevel() * 100.0f,
+                                governor.isReducing() ? " (reduced)" : "");
+                }
+
+                // Keep the last image while nothing the shader reads has changed
+                bool cached = shaderLayer->isCached();
+                if (ImGui::Checkbox("Cache When Idle", &cached)) {
+                    shaderLayer->setCached(cached);
+                }
+
+                // Variants of the shader rendered next to the viewport with the same inputs
+                bool compare = comparison != nullptr;
+                if (ImGui::Checkbox("A/B Comparison", &compare)) {
+                    comparison = compare ? std::make_unique<ShaderComparison>(shaderLayer) : nullptr;
+                }
             }
             
             ImGui::Spacing();
@@ -340,6 +421,36 @@ class ShaderTest : public KiwiCore {
                 ImGui::Text("Mouse (normalized): %.3f, %.3f", mouse.x, mouse.y);
                 ImGui::Text("Mouse Down: %s", shaderLayer->isMouseDown() ? "Yes" : "No");
                 ImGui::Text("Parsed Uniforms: %zu", uniforms.size());
+                ImGui::Text("Parallel Compile: %s", shaderLayer->isParallelCompileSupported() ? "Yes" : "No");
+            }
+            
+            ImGui::Spacing();
+            ImGui::Separator();
+            
+            // ===== Reload Timing =====
+            if (ImGui::CollapsingHeader("Reload Timing")) {
+                const auto& history = shaderLayer->getReloadHistory();
+                if (history.empty()) {
+                    ImGui::TextDisabled("No reloads recorded yet");
+                } else {
+                    const ReloadTiming& last = history.back();
+                    ImGui::Text("Preprocess: %.2f ms", last.preprocessMs);
+                    ImGui::Text("Compile:    %.2f ms", last.compileMs);
+                    ImGui::Text("Link:       %.2f ms", last.linkMs);
+                    ImGui::Text("Parse:      %.2f ms", last.parseMs);
+                    ImGui::Text("Locations:  %.2f ms", last.locationsMs);
+                    ImGui::Text("Total:      %.2f ms%s", last.totalMs, last.success ? "" : " (failed)");
+
+                    std::vector<float> totals;
+                    for (const auto& timing : history) {
+                        totals.push_back(static_cast<float>(timing.totalMs));
+                    }
+                    ImGui::PlotLines("##reload_totals", totals.data(), static_cast<int>(totals.size()),
+                                     0, "Total (ms)", 0.0f, FLT_MAX, ImVec2(-1, 50));
+                }
+                if (ImGui::Button("Export JSON")) {
+                    shaderLayer->saveReloadHistory("reload_timings.json");
+                }
             }
             
             ImGui::Spacing();
@@ -461,7 +572,9 @@ class ShaderTest : public KiwiCore {
             ImGui::Spacing();
             
             // Render uniform controls
-            Uniforms::UniformEditor::renderControls(uniforms);
+            if (Uniforms::UniformEditor::renderControls(uniforms)) {
+                shaderLayer->invalidate();
+            }
             
             ImGui::End();
         }
@@ -615,6 +728,10 @@ class ShaderTest : public KiwiCore {
         }
         
         ImGui::End();
+
+        if (comparison) {
+            comparison->drawWindows();
+        }
     }
 };
 
@@ -0,0 +1,460 @@
+/**
+ * @file Batch2D.cpp
+ * @brief Implementation of the 2D batch renderer.
+ */
+
+#include "utility/Batch2D.h"
+
+#include <algorithm>
+#include <cstddef>
+
+// Objects per depth range; exceeding it flushes and clears the depth buffer
+static constexpr size_t MAX_BATCH_OBJECTS = 1 << 20;
+static constexpr float BATCH_DEPTH_STEP = 2.0f / float(MAX_BATCH_OBJECTS + 1);
+
+// Same as the flat shader, but position is already in world space and
+// color/highlight come from the vertex instead of uniforms.
+static const std::string batchVertexShader = R"(
+    #version 330 core
+    layout(location=0) in vec2 position;
+    layout(location=1) in float depth;
+    layout(location=2) in float highlight;
+    layout(location=3) in vec4 color;
+
+    uniform mat3 camera;
+
+    out vec2 ndcCoord;
+    out vec4 vColor;
+    out float vHighlight;
+
+    void main() {
+       vec3 tr_position = camera * vec3(position, 1.0);
+       ndcCoord = tr_position.xy;
+       vColor = color;
+       vHighlight = highlight;
+       gl_Position = vec4(tr_position.xy, depth * tr_position.z, tr_position.z);
+    }
+)";
+
+static const std::string batchFragmentShader = R"(
+    #version 330 core
+    layout(location=0) out vec4 fragColor;
+
+    in vec2 ndcCoord;
+    in vec4 vColor;
+    in float vHighlight;
+
+    uniform vec2 mousePos;
+
+    void main() {
+        float distanceToMouse = distance(ndcCoord, mousePos);
+        float highlightIntensity_ = 1.0 - smoothstep(0.0, 0.25, distanceToMouse);
+        highlightIntensity_ *= vHighlight;
+
+        vec4 lighterColor = clamp(vColor + 0.5, 0.0, 1.0);
+        fragColor = mix(vColor, lighterColor, highlightIntensity_);
+    }
+)";
+
+// Unit quad instanced per SDF primitive. The quad is grown by a few pixels so
+// the antialiased edge is not clipped; the distance is converted to pixels
+// with screen-space derivatives, which keeps edges crisp at any zoom.
+static const std::string sdfVertexShader = R"(
+    #version 330 core
+    layout(location=0) in vec2 corner;
+    layout(location=1) in vec3 transform0;
+    layout(location=2) in vec3 transform1;
+    layout(location=3) in vec3 transform2;
+    layout(location=4) in vec4 fillColor;
+    layout(location=5) in vec4 strokeColor;
+    layout(location=6) in vec4 shape;
+    layout(location=7) in float depth;
+
+    uniform mat3 camera;
+    uniform vec2 viewportSize;
+
+    out vec2 localPos;
+    out vec2 ndcCoord;
+    flat out vec4 vFill;
+    flat out vec4 vStroke;
+    flat out vec4 vShape;
+    flat out vec2 vSize;
+
+    void main() {
+        mat3 model = mat3(transform0, transform1, transform2);
+        mat3 mvp = camera * model;
+
+        // Pad by 2 pixels on each side (in local units)
+        vec2 pixelsPerUnit = vec2(length(mvp[0].xy * viewportSize * 0.5),
+                                  length(mvp[1].xy * viewportSize * 0.5));
+        vec2 pad = 2.0 / max(pixelsPerUnit, vec2(1e-6));
+        localPos = corner + sign(corner) * pad;
+
+        vec3 tr_position = mvp * vec3(localPos, 1.0);
+        ndcCoord = tr_position.xy;
+        gl_Position = vec4(tr_position.xy, depth * tr_position.z, tr_position.z);
+
+        vFill = fillColor;
+        vStroke = strokeColor;
+        vShape = shape;
+        vSize = vec2(length(model[0].xy), length(model[1].xy));
+    }
+)";
+
+static const std::string sdfFragmentShader = R"(
+    #version 330 core
+    layout(location=0) out vec4 fragColor;
+
+    in vec2 localPos;
+    in vec2 ndcCoord;
+    flat in vec4 vFill;
+    flat in vec4 vStroke;
+    flat in vec4 vShape;
+    flat in vec2 vSize;
+
+    uniform vec2 mousePos;
+
+    float sdRoundedBox(vec2 p, vec2 halfSize, float radius) {
+        vec2 q = abs(p) - halfSize + radius;
+        return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+    }
+
+    void main() {
+        int kind = int(vShape.x + 0.5);
+        float d;
+        if (kind == 1) {
+            // Rounded rectangle, evaluated in model units so corners stay round
+            float radius = clamp(vShape.y, 0.0, 0.5) * min(vSize.x, vSize.y);
+            d = sdRoundedBox(localPos * vSize, vSize * 0.5, radius);
+        } else if (kind == 2) {
+            // Ring, parameter is the inner radius relative to the outer one
+            float inner = clamp(vShape.y, 0.0, 1.0) * 0.5;
+            d = abs(length(localPos) - (0.5 + inner) * 0.5) - (0.5 - inner) * 0.5;
+        } else {
+            d = length(localPos) - 0.5;
+        }
+
+        // Distance in pixels
+        float pixelDistance = d / max(length(vec2(dFdx(d), dFdy(d))), 1e-6);
+        float coverage = clamp(0.5 - pixelDistance, 0.0, 1.0);
+        float strokeWidth = vShape.z;
+        float strokeMix = strokeWidth > 0.0 ? clamp(pixelDistance + strokeWidth + 0.5, 0.0, 1.0) : 0.0;
+
+        vec4 color = mix(vFill, vStroke, strokeMix);
+        color.a *= coverage;
+        if (color.a < 1.0 / 255.0) discard;
+
+        float distanceToMouse = distance(ndcCoord, mousePos);
+        float highlightIntensity_ = (1.0 - smoothstep(0.0, 0.25, distanceToMouse)) * vShape.w;
+        vec4 lighterColor = clamp(color + 0.5, 0.0, 1.0);
+        fragColor = vec4(mix(color.rgb, lighterColor.rgb, highlightIntensity_), color.a);
+    }
+)";
+
+BatchRenderer2D::BatchRenderer2D() {
+    shader_ = std::make_shared<Shader>(batchVertexShader, batchFragmentShader);
+    sdfShader_ = std::make_shared<Shader>(sdfVertexShader, sdfFragmentShader);
+    createStream(triangles_, true);
+    createStream(lines_, false);
+    createInstanceStream();
+}
+
+BatchRenderer2D::~BatchRenderer2D() {
+    destroyStream(triangles_);
+    destroyStream(lines_);
+    if (sdf_.vertexArray != 0) glDeleteVertexArrays(1, &sdf_.vertexArray);
+    if (sdf_.quadBuffer != 0) glDeleteBuffers(1, &sdf_.quadBuffer);
+    if (sdf_.instanceBuffer != 0) glDeleteBuffers(1, &sdf_.instanceBuffer);
+}
+
+//region ------------------------------- Streams ------------------------------
+
+void BatchRenderer2D::createStream(Stream& stream, bool indexed) {
+    GL_TRY(glGenVertexArrays(1, &stream.vertexArray));
+    GL_TRY(glBindVertexArray(stream.vertexArray));
+
+    GL_TRY(glGenBuffers(1, &stream.vertexBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, stream.vertexBuffer));
+
+    if (indexed) {
+        // The element buffer binding is part of the VAO state
+        GL_TRY(glGenBuffers(1, &stream.indexBuffer));
+        GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.indexBuffer));
+    }
+
+    // Layout
+    {
+        const auto stride = (GLsizei) sizeof(BatchVertex2D);
+        GL_TRY(glEnableVertexAttribArray(0));
+        GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchVertex2D, position)));
+        GL_TRY(glEnableVertexAttribArray(1));
+        GL_TRY(glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchVertex2D, depth)));
+        GL_TRY(glEnableVertexAttribArray(2));
+        GL_TRY(glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchVertex2D, highlight)));
+        GL_TRY(glEnableVertexAttribArray(3));
+        GL_TRY(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchVertex2D, color)));
+    }
+
+    GL_TRY(glBindVertexArray(0));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void BatchRenderer2D::createInstanceStream() {
+    GL_TRY(glGenVertexArrays(1, &sdf_.vertexArray));
+    GL_TRY(glBindVertexArray(sdf_.vertexArray));
+
+    // Unit quad as a triangle strip (counter-clockwise)
+    float quad[] = {
+            -0.5f, -0.5f,
+             0.5f, -0.5f,
+            -0.5f,  0.5f,
+             0.5f,  0.5f
+    };
+    GL_TRY(glGenBuffers(1, &sdf_.quadBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, sdf_.quadBuffer));
+    GL_TRY(glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW));
+    GL_TRY(glEnableVertexAttribArray(0));
+    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+
+    // Per-instance attributes
+    {
+        GL_TRY(glGenBuffers(1, &sdf_.instanceBuffer));
+        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, sdf_.instanceBuffer));
+
+        const auto stride = (GLsizei) sizeof(BatchInstance2D);
+        for (unsigned int column = 0; column < 3; column++) {
+            size_t offset = offsetof(BatchInstance2D, transform) + column * sizeof(glm::vec3);
+            GL_TRY(glEnableVertexAttribArray(1 + column));
+            GL_TRY(glVertexAttribPointer(1 + column, 3, GL_FLOAT, GL_FALSE, stride, (void*) offset));
+            GL_TRY(glVertexAttribDivisor(1 + column, 1));
+        }
+        GL_TRY(glEnableVertexAttribArray(4));
+        GL_TRY(glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchInstance2D, fillColor)));
+        GL_TRY(glVertexAttribDivisor(4, 1));
+        GL_TRY(glEnableVertexAttribArray(5));
+        GL_TRY(glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchInstance2D, strokeColor)));
+        GL_TRY(glVertexAttribDivisor(5, 1));
+        GL_TRY(glEnableVertexAttribArray(6));
+        GL_TRY(glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchInstance2D, shape)));
+        GL_TRY(glVertexAttribDivisor(6, 1));
+        GL_TRY(glEnableVertexAttribArray(7));
+        GL_TRY(glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(BatchInstance2D, depth)));
+        GL_TRY(glVertexAttribDivisor(7, 1));
+    }
+
+    GL_TRY(glBindVertexArray(0));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void BatchRenderer2D::destroyStream(Stream& stream) {
+    if (stream.vertexArray != 0) glDeleteVertexArrays(1, &stream.vertexArray);
+    if (stream.vertexBuffer != 0) glDeleteBuffers(1, &stream.vertexBuffer);
+    if (stream.indexBuffer != 0) glDeleteBuffers(1, &stream.indexBuffer);
+}
+
+void BatchRenderer2D::upload(Stream& stream) {
+    // Orphan the previous storage so the driver does not wait for the last draw,
+    // and only reallocate (doubling) when the batch outgrows it.
+    glBindBuffer(GL_ARRAY_BUFFER, stream.vertexBuffer);
+    if (stream.vertices.size() > stream.vertexCapacity) {
+        stream.vertexCapacity = std::max(stream.vertices.size(), stream.vertexCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, stream.vertexCapacity * sizeof(BatchVertex2D), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, stream.vertices.size() * sizeof(BatchVertex2D), stream.vertices.data());
+
+    if (stream.indexBuffer != 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.indexBuffer);
+        if (stream.indices.size() > stream.indexCapacity) {
+            stream.indexCapacity = std::max(stream.indices.size(), stream.indexCapacity * 2);
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, stream.indexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, stream.indices.size() * sizeof(unsigned int), stream.indices.data());
+    }
+}
+
+//endregion
+
+
+//region -------------------------------- Frame -------------------------------
+
+void BatchRenderer2D::begin(const glm::mat3& camera, glm::vec2 mousePosition) {
+    camera_ = camera;
+    mousePosition_ = mousePosition;
+    objectIndex_ = 0;
+    stats_ = BatchStats2D{};
+
+    // Depth only orders the objects of this layer
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void BatchRenderer2D::submit(Object2D& object, const glm::mat3& model) {
+    if (objectIndex_ >= MAX_BATCH_OBJECTS) {
+        flush();
+        glClear(GL_DEPTH_BUFFER_BIT);
+        objectIndex_ = 0;
+    }
+
+    objectIndex_++;
+    depth_ = 1.0f - float(objectIndex_) * BATCH_DEPTH_STEP;
+    stats_.objects++;
+
+    if (object.appendToBatch(*this, model)) return;
+
+    // Keep the draw order: everything before this object has to be on screen first
+    flush();
+    stats_.fallbacks++;
+    Shaders::flatShader->setUniform3x3f("transform", model);
+    object.draw();
+}
+
+void BatchRenderer2D::end() {
+    flush();
+}
+
+void BatchRenderer2D::flush() {
+    if (triangles_.vertices.empty() && lines_.vertices.empty() && sdf_.instances.empty()) return;
+
+    // Outlines are drawn after all fills, per-object depth puts them back in order
+    GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+    GLint previousDepthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &previousDepthFunc);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    shader_->bind();
+    shader_->setUniform3x3f("camera", camera_);
+    shader_->setUniform2f("mousePos", mousePosition_.x, mousePosition_.y);
+
+    if (!triangles_.vertices.empty()) {
+        glBindVertexArray(triangles_.vertexArray);
+        upload(triangles_);
+        glDrawElements(GL_TRIANGLES, (GLsizei) triangles_.indices.size(), GL_UNSIGNED_INT, nullptr);
+        stats_.vertices += triangles_.vertices.size();
+        stats_.drawCalls++;
+    }
+
+    if (!lines_.vertices.empty()) {
+        glBindVertexArray(lines_.vertexArray);
+        upload(lines_);
+        glDrawArrays(GL_LINES, 0, (GLsizei) lines_.vertices.size());
+        stats_.vertices += lines_.vertices.size();
+        stats_.drawCalls++;
+    }
+
+    if (!sdf_.instances.empty()) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        sdfShader_->bind();
+        sdfShader_->setUniform3x3f("camera", camera_);
+        sdfShader_->setUniform2f("viewportSize", (float) viewport[2], (float) viewport[3]);
+        sdfShader_->setUniform2f("mousePos", mousePosition_.x, mousePosition_.y);
+
+        glBindVertexArray(sdf_.vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, sdf_.instanceBuffer);
+        if (sdf_.instances.size() > sdf_.capacity) {
+            sdf_.capacity = std::max(sdf_.instances.size(), sdf_.capacity * 2);
+        }
+        glBufferData(GL_ARRAY_BUFFER, sdf_.capacity * sizeof(BatchInstance2D), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sdf_.instances.size() * sizeof(BatchInstance2D), sdf_.instances.data());
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) sdf_.instances.size());
+        stats_.instances += sdf_.instances.size();
+        stats_.drawCalls++;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // restore the previous settings
+    glDepthFunc(previousDepthFunc);
+    if (!depthTestEnabled) glDisable(GL_DEPTH_TEST);
+
+    triangles_.vertices.clear();
+    triangles_.indices.clear();
+    lines_.vertices.clear();
+    sdf_.instances.clear();
+
+    // Fallback draws use the flat shader again
+    Shaders::flatShader->bind();
+}
+
+//endregion
+
+
+//region ------------------------------- Geometry -----------------------------
+
+bool BatchRenderer2D::accepts(const std::shared_ptr<Material>& material) {
+    return material && material->getShader() == Shaders::flatShader;
+}
+
+BatchVertex2D BatchRenderer2D::makeVertex(glm::vec2 point, const glm::mat3& model, const Material& material) const {
+    glm::vec3 world = model * glm::vec3(point, 1.0f);
+    return {glm::vec2(world), depth_, material.getHighlight(), material.getColor()};
+}
+
+void BatchRenderer2D::addTriangleFan(const glm::vec2* points, size_t count, const glm::mat3& model,
+                                     const Material& material) {
+    if (count < 3) return;
+
+    auto base = (unsigned int) triangles_.vertices.size();
+    for (size_t i = 0; i < count; i++) {
+        triangles_.vertices.push_back(makeVertex(points[i], model, material));
+    }
+    for (unsigned int i = 1; i + 1 < count; i++) {
+        triangles_.indices.push_back(base);
+        triangles_.indices.push_back(base + i);
+        triangles_.indices.push_back(base + i + 1);
+    }
+}
+
+void BatchRenderer2D::addTriangles(const glm::vec2* points, size_t count, const unsigned int* indices,
+                                   size_t indexCount, const glm::mat3& model, const Material& material) {
+    if (count < 3 || indexCount < 3) return;
+
+    auto base = (unsigned int) triangles_.vertices.size();
+    for (size_t i = 0; i < count; i++) {
+        triangles_.vertices.push_back(makeVertex(points[i], model, material));
+    }
+    for (size_t i = 0; i < indexCount; i++) {
+        triangles_.indices.push_back(base + indices[i]);
+    }
+}
+
+void BatchRenderer2D::addLineLoop(const glm::vec2* points, size_t count, const glm::mat3& model,
+                                  const Material& material) {
+    if (count < 2) return;
+
+    BatchVertex2D first = makeVertex(points[0], model, material);
+    BatchVertex2D previous = first;
+    for (size_t i = 1; i < count; i++) {
+        BatchVertex2D current = makeVertex(points[i], model, material);
+        lines_.vertices.push_back(previous);
+        lines_.vertices.push_back(current);
+        previous = current;
+    }
+    lines_.vertices.push_back(previous);
+    lines_.vertices.push_back(first);
+}
+
+void BatchRenderer2D::addLine(glm::vec2 from, glm::vec2 to, const glm::mat3& model, const Material& material) {
+    lines_.vertices.push_back(makeVertex(from, model, material));
+    lines_.vertices.push_back(makeVertex(to, model, material));
+}
+
+void BatchRenderer2D::addInstance(SdfPrimitive2D::Shape shape, float parameter, float strokeWidth,
+                                  const glm::mat3& model, const Material* fill, const Material* stroke) {
+    if (!fill && !stroke) return;
+
+    BatchInstance2D instance{};
+    instance.transform = model;
+    instance.fillColor = fill ? fill->getColor() : glm::vec4(0.0f);
+    instance.strokeColor = stroke ? stroke->getColor() : glm::vec4(0.0f);
+    // Without a fill the interior fades to the stroke color, not to black
+    if (!fill) instance.fillColor = glm::vec4(glm::vec3(instance.strokeColor), 0.0f);
+    instance.shape = glm::vec4((float) shape, parameter, stroke ? strokeWidth : 0.0f,
+                               (fill ? fill : stroke)->getHighlight());
+    instance.depth = depth_;
+    sdf_.instances.push_back(instance);
+}
+
+//endregion
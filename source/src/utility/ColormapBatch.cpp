@@ -0,0 +1,278 @@
+/**
+ * @file ColormapBatch.cpp
+ * @brief Implementation of the batch colormapping functions.
+ */
+
+#include "utility/ColormapBatch.h"
+#include "utility/Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KIWI_COLORMAP_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles AVX2 intrinsics in any function, GCC/Clang need the target enabled per function
+#if defined(KIWI_COLORMAP_X86) && (defined(__GNUC__) || defined(__clang__))
+#define KIWI_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define KIWI_TARGET_AVX2
+#endif
+
+static constexpr int COLORMAP_SIZE = 512;
+static constexpr size_t COLORMAP_COUNT = 3;
+
+// Tables as RGBX floats in [0, 255]: one gather per channel with index * 4
+using FloatTable = std::array<float, COLORMAP_SIZE * 4>;
+
+static const FloatTable& getFloatTable(Colormap colormap) {
+    static const std::array<FloatTable, COLORMAP_COUNT> tables = [] {
+        std::array<FloatTable, COLORMAP_COUNT> result{};
+        for (size_t c = 0; c < COLORMAP_COUNT; c++) {
+            const unsigned char (*table)[3] = ColormapTables::getTable(static_cast<Colormap>(c));
+            for (int i = 0; i < COLORMAP_SIZE; i++) {
+                for (int k = 0; k < 3; k++) result[c][i * 4 + k] = float(table[i][k]);
+                result[c][i * 4 + 3] = 0.0f;
+            }
+        }
+        return result;
+    }();
+    auto index = static_cast<size_t>(colormap);
+    return tables[index < COLORMAP_COUNT ? index : 0];
+}
+
+static bool simdEnabled = true;
+
+//----------------------------------------------------------------------------------------------------------------------
+//      Scalar path
+//----------------------------------------------------------------------------------------------------------------------
+
+// Position in the table: entry index (at most 510) and fraction towards the next entry
+static inline void locate(float value, float offset, float scale, int& index, float& fraction) {
+    float t = (value - offset) * scale;
+    t = t > 0.0f ? t : 0.0f;                       // also NaN
+    t = t < float(COLORMAP_SIZE - 1) ? t : float(COLORMAP_SIZE - 1);
+    index = std::min(int(t), COLORMAP_SIZE - 2);
+    fraction = t - float(index);
+}
+
+static void mapToRGBA8Scalar(const float* values, size_t count, float offset, float scale, const float* table,
+                             uint32_t* out, uint32_t alphaBits) {
+    for (size_t i = 0; i < count; i++) {
+        int index;
+        float fraction;
+        locate(values[i], offset, scale, index, fraction);
+        const float* a = table + index * 4;
+        const float* b = a + 4;
+        uint32_t pixel = alphaBits;
+        for (int k = 0; k < 3; k++) {
+            float channel = a[k] + fraction * (b[k] - a[k]);
+            pixel |= uint32_t(channel + 0.5f) << (8 * k);
+        }
+        out[i] = pixel;
+    }
+}
+
+static void mapToRGBScalar(const float* values, size_t count, float offset, float scale, const float* table,
+                           float* out) {
+    for (size_t i = 0; i < count; i++) {
+        int index;
+        float fraction;
+        locate(values[i], offset, scale, index, fraction);
+        const float* a = table + index * 4;
+        const float* b = a + 4;
+        for (int k = 0; k < 3; k++) {
+            out[i * 3 + k] = (a[k] + fraction * (b[k] - a[k])) * (1.0f / 255.0f);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//      AVX2 path
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifdef KIWI_COLORMAP_X86
+
+// Same arithmetic as locate() and the scalar interpolation, eight values at a time
+KIWI_TARGET_AVX2
+static inline void interpolate8(const float* values, __m256 offset, __m256 scale, const float* table,
+                                __m256& r, __m256& g, __m256& b) {
+    __m256 t = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(values), offset), scale);
+    t = _mm256_max_ps(t, _mm256_setzero_ps());     // returns the second operand for NaN
+    t = _mm256_min_ps(t, _mm256_set1_ps(float(COLORMAP_SIZE - 1)));
+    __m256i index = _mm256_min_epi32(_mm256_cvttps_epi32(t), _mm256_set1_epi32(COLORMAP_SIZE - 2));
+    __m256 fraction = _mm256_sub_ps(t, _mm256_cvtepi32_ps(index));
+
+    __m256i lower = _mm256_slli_epi32(index, 2);
+    __m256i upper = _mm256_add_epi32(lower, _mm256_set1_epi32(4));
+    __m256 channels[3];
+    for (int k = 0; k < 3; k++) {
+        __m256 a = _mm256_i32gather_ps(table + k, lower, 4);
+        __m256 c = _mm256_i32gather_ps(table + k, upper, 4);
+        channels[k] = _mm256_add_ps(a, _mm256_mul_ps(fraction, _mm256_sub_ps(c, a)));
+    }
+    r = channels[0];
+    g = channels[1];
+    b = channels[2];
+}
+
+KIWI_TARGET_AVX2
+static size_t mapToRGBA8AVX2(const float* values, size_t count, float offset, float scale, const float* table,
+                             uint32_t* out, uint32_t alphaBits) {
+    const __m256 offset8 = _mm256_set1_ps(offset);
+    const __m256 scale8 = _mm256_set1_ps(scale);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i alpha8 = _mm256_set1_epi32(static_cast<int>(alphaBits));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 r, g, b;
+        interpolate8(values + i, offset8, scale8, table, r, g, b);
+        __m256i pixel = _mm256_or_si256(alpha8, _mm256_cvttps_epi32(_mm256_add_ps(r, half)));
+        pixel = _mm256_or_si256(pixel, _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_add_ps(g, half)), 8));
+        pixel = _mm256_or_si256(pixel, _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_add_ps(b, half)), 16));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), pixel);
+    }
+    return i;
+}
+
+KIWI_TARGET_AVX2
+static size_t mapToRGBAVX2(const float* values, size_t count, float offset, float scale, const float* table,
+                           float* out) {
+    const __m256 offset8 = _mm256_set1_ps(offset);
+    const __m256 scale8 = _mm256_set1_ps(scale);
+    const __m256 normalize = _mm256_set1_ps(1.0f / 255.0f);
+
+    size_t i = 0;
+    alignas(32) float channels[3][8];
+    for (; i + 8 <= count; i += 8) {
+        __m256 r, g, b;
+        interpolate8(values + i, offset8, scale8, table, r, g, b);
+        _mm256_store_ps(channels[0], _mm256_mul_ps(r, normalize));
+        _mm256_store_ps(channels[1], _mm256_mul_ps(g, normalize));
+        _mm256_store_ps(channels[2], _mm256_mul_ps(b, normalize));
+
+        // Interleave to RGB
+        float* dst = out + i * 3;
+        for (int j = 0; j < 8; j++) {
+            dst[j * 3 + 0] = channels[0][j];
+            dst[j * 3 + 1] = channels[1][j];
+            dst[j * 3 + 2] = channels[2][j];
+        }
+    }
+    return i;
+}
+
+static bool detectAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    // The OS must save the YMM registers
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+//      ColormapBatch
+//----------------------------------------------------------------------------------------------------------------------
+
+// Normalization as offset and scale to [0, 511]; an empty range maps everything to the low end
+static inline void normalization(float minValue, float maxValue, float& offset, float& scale) {
+    offset = minValue;
+    float range = maxValue - minValue;
+    scale = range != 0.0f ? float(COLORMAP_SIZE - 1) / range : 0.0f;
+}
+
+bool ColormapBatch::hasAVX2() {
+#ifdef KIWI_COLORMAP_X86
+    static const bool supported = detectAVX2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void ColormapBatch::setSimdEnabled(bool enabled) {
+    simdEnabled = enabled;
+}
+
+void ColormapBatch::mapToRGBA8(std::span<const float> values, float minValue, float maxValue, Colormap colormap,
+                               uint32_t* out, uint8_t alpha) {
+    float offset, scale;
+    normalization(minValue, maxValue, offset, scale);
+    const float* table = getFloatTable(colormap).data();
+    uint32_t alphaBits = uint32_t(alpha) << 24;
+
+    size_t done = 0;
+#ifdef KIWI_COLORMAP_X86
+    if (simdEnabled && hasAVX2()) done = mapToRGBA8AVX2(values.data(), values.size(), offset, scale, table, out, alphaBits);
+#endif
+    mapToRGBA8Scalar(values.data() + done, values.size() - done, offset, scale, table, out + done, alphaBits);
+}
+
+void ColormapBatch::mapToRGB(std::span<const float> values, float minValue, float maxValue, Colormap colormap,
+                             float* out) {
+    float offset, scale;
+    normalization(minValue, maxValue, offset, scale);
+    const float* table = getFloatTable(colormap).data();
+
+    size_t done = 0;
+#ifdef KIWI_COLORMAP_X86
+    if (simdEnabled && hasAVX2()) done = mapToRGBAVX2(values.data(), values.size(), offset, scale, table, out);
+#endif
+    mapToRGBScalar(values.data() + done, values.size() - done, offset, scale, table, out + done * 3);
+}
+
+ColormapBatch::BenchmarkResult ColormapBatch::benchmark(size_t samples, int repetitions) {
+    std::vector<float> values(samples);
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-0.1f, 1.1f);
+    for (float& value: values) value = distribution(generator);
+    std::vector<uint32_t> pixels(samples);
+
+    // Best of the repetitions, after one warm-up run
+    auto measure = [&](bool simd) {
+        bool previous = simdEnabled;
+        simdEnabled = simd;
+        mapToRGBA8(values, 0.0f, 1.0f, Colormap::Viridis, pixels.data());
+        double best = 0.0;
+        for (int r = 0; r < repetitions; r++) {
+            auto start = std::chrono::steady_clock::now();
+            mapToRGBA8(values, 0.0f, 1.0f, Colormap::Viridis, pixels.data());
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() > 0.0) best = std::max(best, double(samples) / elapsed.count());
+        }
+        simdEnabled = previous;
+        return best;
+    };
+
+    BenchmarkResult result;
+    result.scalarSamplesPerSecond = measure(false);
+    if (hasAVX2()) result.simdSamplesPerSecond = measure(true);
+
+    Logger::Info("ColormapBatch", std::format("RGBA8: scalar {:.0f} M samples/s, AVX2 {}", result.scalarSamplesPerSecond / 1e6,
+                 hasAVX2() ? std::format("{:.0f} M samples/s", result.simdSamplesPerSecond / 1e6) : "not supported"),
+                 {"benchmark"});
+    return result;
+}
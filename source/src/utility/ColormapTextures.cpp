@@ -0,0 +1,41 @@
+/**
+ * @file ColormapTextures.cpp
+ * @brief Implementation of the shared colormap lookup textures.
+ */
+
+#include "utility/ColormapTextures.h"
+
+#include <array>
+
+static constexpr size_t COLORMAP_COUNT = 3;
+static constexpr GLsizei COLORMAP_SIZE = 512;
+
+static std::array<GLuint, COLORMAP_COUNT> textures{};
+
+GLuint ColormapTextures::get(Colormap colormap) {
+    auto index = static_cast<size_t>(colormap);
+    if (index >= COLORMAP_COUNT) index = 0;
+    if (textures[index] != 0) return textures[index];
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_1D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, COLORMAP_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                 ColormapTables::getTable(colormap));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_1D, 0);
+
+    textures[index] = texture;
+    return texture;
+}
+
+void ColormapTextures::release() {
+    for (GLuint& texture: textures) {
+        if (texture != 0) glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
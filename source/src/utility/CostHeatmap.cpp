@@ -0,0 +1,215 @@
+/**
+ * @file CostHeatmap.cpp
+ * @brief Implementation of the per-pixel cost heatmap.
+ */
+
+#include "utility/CostHeatmap.h"
+#include "utility/ColormapTextures.h"
+#include "utility/Logger.h"
+
+#include <algorithm>
+#include <string>
+
+// Fullscreen quad vertex shader (positions only, same layout as ShaderLayer)
+static const char* heatmapVertexSource = R"(
+#version 330 core
+layout(location = 0) in vec2 aPos;
+
+out vec2 uv;
+
+void main() {
+    uv = aPos * 0.5 + 0.5;
+    gl_Position = vec4(aPos, 0.0, 1.0);
+}
+)";
+
+// Maps the captured cost through the 1D colormap, normalized to [min, max]
+static const char* heatmapFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+
+uniform sampler2D costTexture;
+uniform sampler1D colormap;
+uniform vec2 costRange;
+
+void main() {
+    float cost = texture(costTexture, uv).r;
+    float t = clamp((cost - costRange.x) / max(costRange.y - costRange.x, 1.0), 0.0, 1.0);
+    fragColor = vec4(texture(colormap, t).rgb, 1.0);
+}
+)";
+
+CostHeatmap::~CostHeatmap() {
+    if (framebuffer_ != 0) {
+        glDeleteFramebuffers(1, &framebuffer_);
+    }
+    if (colorTexture_ != 0) {
+        glDeleteTextures(1, &colorTexture_);
+    }
+    if (costTexture_ != 0) {
+        glDeleteTextures(1, &costTexture_);
+    }
+    if (program_ != 0) {
+        glDeleteProgram(program_);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Setup
+//------------------------------------------------------------------------------
+bool CostHeatmap::initialize() {
+    if (initialized_) {
+        return true;
+    }
+
+    // Compile display shader
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &heatmapVertexSource, nullptr);
+    glCompileShader(vertexShader);
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &heatmapFragmentSource, nullptr);
+    glCompileShader(fragmentShader);
+
+    program_ = glCreateProgram();
+    glAttachShader(program_, vertexShader);
+    glAttachShader(program_, fragmentShader);
+    glLinkProgram(program_);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program_, 512, nullptr, infoLog);
+        Logger::Error("CostHeatmap", "Shader link error: " + std::string(infoLog), {"graphics", "shader"});
+        glDeleteProgram(program_);
+        program_ = 0;
+        return false;
+    }
+
+    costTextureLoc_ = glGetUniformLocation(program_, "costTexture");
+    colormapLoc_ = glGetUniformLocation(program_, "colormap");
+    costRangeLoc_ = glGetUniformLocation(program_, "costRange");
+
+    // Capture target: attachment 0 receives the shader's color, attachment 1 its cost
+    glGenFramebuffers(1, &framebuffer_);
+    glGenTextures(1, &colorTexture_);
+    glGenTextures(1, &costTexture_);
+
+    initialized_ = true;
+    return true;
+}
+
+void CostHeatmap::resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+
+    glBindTexture(GL_TEXTURE_2D, colorTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glBindTexture(GL_TEXTURE_2D, costTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture_, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, costTexture_, 0);
+    GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        Logger::Error("CostHeatmap", "Capture framebuffer is incomplete", {"graphics"});
+    }
+
+    readback_.resize(static_cast<size_t>(width) * height);
+}
+
+void CostHeatmap::setColormap(HeatmapColormap colormap) {
+    colormap_ = colormap;
+}
+
+//------------------------------------------------------------------------------
+// Capture and display
+//------------------------------------------------------------------------------
+bool CostHeatmap::begin(int width, int height) {
+    if (!initialize() || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer_);
+    glGetIntegerv(GL_VIEWPORT, previousViewport_);
+
+    if (width != width_ || height != height_) {
+        resize(width, height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+
+    const GLfloat clearColor[] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat clearCost[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glClearBufferfv(GL_COLOR, 0, clearColor);
+    glClearBufferfv(GL_COLOR, 1, clearCost);
+    return true;
+}
+
+void CostHeatmap::updateStats() {
+    // Synchronous readback: this is a diagnostic mode, a pipeline stall is acceptable
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+    glReadPixels(0, 0, width_, height_, GL_RED, GL_FLOAT, readback_.data());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    if (readback_.empty()) {
+        stats_ = CostStats{};
+        return;
+    }
+
+    auto [minIt, maxIt] = std::minmax_element(readback_.begin(), readback_.end());
+    double sum = 0.0;
+    for (float cost : readback_) {
+        sum += cost;
+    }
+
+    stats_.min = *minIt;
+    stats_.max = *maxIt;
+    stats_.mean = static_cast<float>(sum / static_cast<double>(readback_.size()));
+}
+
+void CostHeatmap::end(GLuint quadVAO) {
+    updateStats();
+
+    // Back to the caller's target
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer_);
+    glViewport(previousViewport_[0], previousViewport_[1], previousViewport_[2], previousViewport_[3]);
+
+    glUseProgram(program_);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, costTexture_);
+    glUniform1i(costTextureLoc_, 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    // Shared lookup texture, uploaded on first use
+    glBindTexture(GL_TEXTURE_1D, ColormapTextures::get(
+            colormap_ == HeatmapColormap::Blackbody ? Colormap::Blackbody : Colormap::Viridis));
+    glUniform1i(colormapLoc_, 1);
+
+    glUniform2f(costRangeLoc_, stats_.min, stats_.max);
+
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+
+    // Reset state
+    glBindTexture(GL_TEXTURE_1D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+}
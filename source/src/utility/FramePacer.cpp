@@ -0,0 +1,118 @@
+/**
+ * @file FramePacer.cpp
+ * @brief Implementation of the frame pacer.
+ */
+
+#include "utility/FramePacer.h"
+#include "utility/Logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Spin margin of the capped mode: at least this much, at most a whole frame
+static constexpr double MIN_SPIN_MARGIN = 0.0005;
+// Wait for the previous frame at most this long (a hung driver must not hang the UI)
+static constexpr GLuint64 FRAME_FENCE_TIMEOUT = 100000000;  // ns
+
+FramePacer::~FramePacer() {
+    release();
+}
+
+void FramePacer::setMode(FramePacing mode) {
+    if (mode == mode_) return;
+    mode_ = mode;
+    modeChanged_ = true;
+}
+
+void FramePacer::setTargetRate(double rate) {
+    targetRate_ = std::clamp(rate, MIN_TARGET_RATE, MAX_TARGET_RATE);
+}
+
+const char* FramePacer::getModeName(FramePacing mode) {
+    switch (mode) {
+        case FramePacing::VSync: return "VSync";
+        case FramePacing::Uncapped: return "Uncapped";
+        case FramePacing::Capped: return "Capped";
+        case FramePacing::Adaptive: return "Adaptive VSync";
+    }
+    return "";
+}
+
+//------------------------------------------------------------------------------
+// Frame
+//------------------------------------------------------------------------------
+void FramePacer::beginFrame() {
+    if (modeChanged_) {
+        applySwapInterval();
+        deadline_ = glfwGetTime();
+        modeChanged_ = false;
+    }
+
+    if (frameFence_) {
+        if (limitFrameQueue_) {
+            glClientWaitSync(frameFence_, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT);
+        }
+        glDeleteSync(frameFence_);
+        frameFence_ = nullptr;
+    }
+}
+
+void FramePacer::waitForDeadline() {
+    if (mode_ != FramePacing::Capped) return;
+
+    double interval = 1.0 / targetRate_;
+    double now = glfwGetTime();
+
+    // A frame later than a whole interval starts a new schedule instead of rushing the next ones
+    if (now > deadline_ + interval) deadline_ = now;
+
+    // Sleep while the scheduler cannot overshoot the deadline, then spin
+    double sleepTime = deadline_ - now - spinMargin_;
+    if (sleepTime > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+        double overshoot = glfwGetTime() - now - sleepTime;
+
+        // Follow larger overshoots at once, relax slowly after them
+        spinMargin_ = std::clamp(std::max(overshoot * 1.5, spinMargin_ * 0.95), MIN_SPIN_MARGIN, interval);
+    }
+    while (glfwGetTime() < deadline_) {
+        std::this_thread::yield();
+    }
+    deadline_ += interval;
+}
+
+void FramePacer::endFrame() {
+    if (!limitFrameQueue_) return;
+    if (frameFence_) glDeleteSync(frameFence_);
+    frameFence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FramePacer::release() {
+    if (frameFence_) glDeleteSync(frameFence_);
+    frameFence_ = nullptr;
+}
+
+void FramePacer::applySwapInterval() {
+    switch (mode_) {
+        case FramePacing::VSync:
+            glfwSwapInterval(1);
+            break;
+        case FramePacing::Uncapped:
+        case FramePacing::Capped:
+            glfwSwapInterval(0);
+            break;
+        case FramePacing::Adaptive:
+            if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                glfwSwapInterval(-1);
+            } else {
+                Logger::Warn("FramePacer", "Adaptive vsync is not supported by the driver, using vsync", {"graphics"});
+                glfwSwapInterval(1);
+            }
+            break;
+    }
+    Logger::Info("FramePacer", std::string("Frame pacing: ") + getModeName(mode_), {"graphics"});
+}
@@ -0,0 +1,152 @@
+/**
+ * @file GeometryRegistry2D.cpp
+ * @brief Implementation of the shared 2D geometry.
+ */
+
+#include "utility/GeometryRegistry2D.h"
+#include "utility/common.h"
+
+#include <algorithm>
+#include <cmath>
+
+// M_PI is not defined in MSVC by default
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif
+
+// Initial capacity of the line buffer, in segments
+static constexpr size_t MIN_SEGMENT_CAPACITY = 256;
+
+struct MeshStorage {
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    UnitMesh2D rectangle;
+    UnitMesh2D circle;
+};
+
+struct SegmentStorage {
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    size_t capacity = 0;                    // segments allocated on the GPU
+    std::vector<glm::vec2> vertices;        // two per segment, CPU copy of the buffer
+    std::vector<uint32_t> freeSegments;
+    size_t dirtyBegin = 0;                  // segments to upload
+    size_t dirtyEnd = 0;
+};
+
+static MeshStorage meshes;
+static SegmentStorage segments;
+
+static void setPositionLayout() {
+    GL_TRY(glEnableVertexAttribArray(0));
+    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+}
+
+static void createMeshes() {
+    std::vector<glm::vec2> vertices;
+
+    // Rectangle, counter-clockwise from the bottom left
+    meshes.rectangle = {0, 4, 0, 4};
+    vertices.insert(vertices.end(), {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}});
+
+    // Circle: center, then the closed rim (the outline skips the center)
+    auto first = static_cast<GLint>(vertices.size());
+    constexpr int segmentCount = GeometryRegistry2D::CIRCLE_SEGMENTS;
+    meshes.circle = {first, segmentCount + 2, first + 1, segmentCount};
+    vertices.emplace_back(0.0f, 0.0f);
+    for (int i = 0; i <= segmentCount; i++) {
+        float theta = 2.0f * float(M_PI) * float(i) / float(segmentCount);
+        vertices.emplace_back(0.5f * std::cos(theta), 0.5f * std::sin(theta));
+    }
+
+    GL_TRY(glGenVertexArrays(1, &meshes.vertexArray));
+    GL_TRY(glBindVertexArray(meshes.vertexArray));
+    GL_TRY(glGenBuffers(1, &meshes.vertexBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, meshes.vertexBuffer));
+    GL_TRY(glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(glm::vec2)),
+                        vertices.data(), GL_STATIC_DRAW));
+    setPositionLayout();
+    GL_TRY(glBindVertexArray(0));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+const UnitMesh2D& GeometryRegistry2D::bindMesh(Mesh mesh) {
+    if (!meshes.vertexArray) createMeshes();
+    glBindVertexArray(meshes.vertexArray);
+    return mesh == Mesh::Circle ? meshes.circle : meshes.rectangle;
+}
+
+uint32_t GeometryRegistry2D::allocateSegment(glm::vec2 start, glm::vec2 end) {
+    uint32_t segment;
+    if (!segments.freeSegments.empty()) {
+        segment = segments.freeSegments.back();
+        segments.freeSegments.pop_back();
+    } else {
+        segment = static_cast<uint32_t>(segments.vertices.size() / 2);
+        segments.vertices.resize(segments.vertices.size() + 2);
+    }
+    setSegment(segment, start, end);
+    return segment;
+}
+
+void GeometryRegistry2D::setSegment(uint32_t segment, glm::vec2 start, glm::vec2 end) {
+    segments.vertices[segment * 2] = start;
+    segments.vertices[segment * 2 + 1] = end;
+    if (segments.dirtyBegin == segments.dirtyEnd) {
+        segments.dirtyBegin = segment;
+        segments.dirtyEnd = segment + 1;
+    } else {
+        segments.dirtyBegin = std::min<size_t>(segments.dirtyBegin, segment);
+        segments.dirtyEnd = std::max<size_t>(segments.dirtyEnd, segment + 1);
+    }
+}
+
+void GeometryRegistry2D::releaseSegment(uint32_t segment) {
+    segments.freeSegments.push_back(segment);
+}
+
+void GeometryRegistry2D::bindSegments() {
+    if (!segments.vertexArray) {
+        GL_TRY(glGenVertexArrays(1, &segments.vertexArray));
+        GL_TRY(glGenBuffers(1, &segments.vertexBuffer));
+        GL_TRY(glBindVertexArray(segments.vertexArray));
+        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, segments.vertexBuffer));
+        setPositionLayout();
+    }
+    glBindVertexArray(segments.vertexArray);
+
+    size_t count = segments.vertices.size() / 2;
+    if (count > segments.capacity) {
+        // Grow by doubling and upload everything
+        segments.capacity = std::max(MIN_SEGMENT_CAPACITY, segments.capacity * 2);
+        while (segments.capacity < count) segments.capacity *= 2;
+        glBindBuffer(GL_ARRAY_BUFFER, segments.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(segments.capacity * 2 * sizeof(glm::vec2)),
+                     nullptr, GL_DYNAMIC_DRAW);
+        segments.dirtyBegin = 0;
+        segments.dirtyEnd = count;
+    }
+    if (segments.dirtyBegin < segments.dirtyEnd) {
+        glBindBuffer(GL_ARRAY_BUFFER, segments.vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(segments.dirtyBegin * 2 * sizeof(glm::vec2)),
+                        static_cast<GLsizeiptr>((segments.dirtyEnd - segments.dirtyBegin) * 2 * sizeof(glm::vec2)),
+                        segments.vertices.data() + segments.dirtyBegin * 2);
+        segments.dirtyBegin = segments.dirtyEnd = 0;
+    }
+}
+
+size_t GeometryRegistry2D::getSegmentCount() {
+    return segments.vertices.size() / 2 - segments.freeSegments.size();
+}
+
+void GeometryRegistry2D::release() {
+    if (meshes.vertexArray) glDeleteVertexArrays(1, &meshes.vertexArray);
+    if (meshes.vertexBuffer) glDeleteBuffers(1, &meshes.vertexBuffer);
+    if (segments.vertexArray) glDeleteVertexArrays(1, &segments.vertexArray);
+    if (segments.vertexBuffer) glDeleteBuffers(1, &segments.vertexBuffer);
+    meshes = {};
+
+    // Lines may outlive the context: keep their slots, re-upload on the next bind
+    segments.vertexArray = segments.vertexBuffer = 0;
+    segments.capacity = 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file LatencyProbe.cpp
+ * @brief Implementation of the latency probe.
+ */
+
+#include "utility/LatencyProbe.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+LatencyProbe::~LatencyProbe() {
+    release();
+}
+
+void LatencyProbe::setEnabled(bool enabled) {
+    if (enabled == enabled_) return;
+    enabled_ = enabled;
+    unseenInput_ = frameInput_ = -1.0;
+    sampleCount_ = 0;
+    lastLatency_ = 0.0;
+    if (!enabled) release();
+}
+
+//------------------------------------------------------------------------------
+// Frame
+//------------------------------------------------------------------------------
+void LatencyProbe::onInput(double time) {
+    if (enabled_ && unseenInput_ < 0.0) unseenInput_ = time;
+}
+
+void LatencyProbe::latchFrame() {
+    if (!enabled_ || unseenInput_ < 0.0) return;
+    frameInput_ = unseenInput_;
+    unseenInput_ = -1.0;
+}
+
+void LatencyProbe::endFrame() {
+    if (!enabled_) return;
+    collect();
+    if (frameInput_ < 0.0) return;
+
+    // All queries still in flight: this frame is not measured
+    PendingQuery& slot = queries_[nextQuery_];
+    if (slot.pending) return;
+    if (slot.query == 0) glGenQueries(1, &slot.query);
+
+    glQueryCounter(slot.query, GL_TIMESTAMP);
+    slot.inputTime = frameInput_;
+    slot.pending = true;
+    nextQuery_ = (nextQuery_ + 1) % QUERY_COUNT;
+    frameInput_ = -1.0;
+}
+
+void LatencyProbe::collect() {
+    bool calibrated = false;
+    double gpuToCpu = 0.0;
+
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        // Oldest first, results arrive in submission order
+        PendingQuery& slot = queries_[(nextQuery_ + i) % QUERY_COUNT];
+        if (!slot.pending) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        // Offset from the GPU clock to glfwGetTime(), taken without waiting for the GPU
+        if (!calibrated) {
+            GLint64 gpuNow = 0;
+            glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+            gpuToCpu = glfwGetTime() - static_cast<double>(gpuNow) * 1e-9;
+            calibrated = true;
+        }
+
+        GLuint64 timestamp = 0;
+        glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &timestamp);
+        double presented = static_cast<double>(timestamp) * 1e-9 + gpuToCpu;
+        lastLatency_ = std::max(presented - slot.inputTime, 0.0) * 1000.0;
+        samples_[sampleCount_ % HISTORY] = lastLatency_;
+        sampleCount_++;
+        slot.pending = false;
+    }
+}
+
+double LatencyProbe::getAverageLatency() const {
+    size_t count = std::min(sampleCount_, HISTORY);
+    if (count == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) sum += samples_[i];
+    return sum / static_cast<double>(count);
+}
+
+double LatencyProbe::getMaxLatency() const {
+    size_t count = std::min(sampleCount_, HISTORY);
+    return count == 0 ? 0.0 : *std::max_element(samples_.begin(), samples_.begin() + count);
+}
+
+void LatencyProbe::release() {
+    for (PendingQuery& slot: queries_) {
+        if (slot.query) glDeleteQueries(1, &slot.query);
+        slot = {};
+    }
+    nextQuery_ = 0;
+}
@@ -95,6 +95,7 @@ void Logger::addLogMessage(LogLevel level, const std::string& source, const std:
     }
     
     inst.messages_.emplace_back(level, source, message, tags);
+    inst.revision_++;
     
     // Update caches
     inst.allSources_.insert(source);
@@ -158,6 +159,7 @@ void Logger::setMinLogLevel(LogLevel level) {
 void Logger::clear() {
     auto& inst = getInstance();
     inst.messages_.clear();
+    inst.revision_++;
     inst.allSources_.clear();
     inst.allTags_.clear();
     inst.updateStats();
@@ -167,6 +169,10 @@ std::vector<LogMessage> Logger::getAllMessages() {
     return getInstance().messages_;
 }
 
+uint64_t Logger::getRevision() {
+    return getInstance().revision_;
+}
+
 void Logger::onDraw() {
     getInstance().draw();
 }
@@ -0,0 +1,50 @@
+/**
+ * @file ObjectPool2D.cpp
+ * @brief Implementation of the 2D object block pools.
+ */
+
+#include "utility/ObjectPool2D.h"
+
+#include <algorithm>
+#include <map>
+
+// Block sizes are rounded up to this, which also keeps every block aligned
+static constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+
+BlockPool2D::BlockPool2D(size_t blockSize)
+    : blockSize_((std::max(blockSize, sizeof(FreeBlock)) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT) {}
+
+void* BlockPool2D::allocate() {
+    if (!freeList_) {
+        // New chunk: thread its blocks into the free list, lowest address first
+        chunks_.push_back(std::make_unique<std::byte[]>(blockSize_ * CHUNK_BLOCKS));
+        std::byte* chunk = chunks_.back().get();
+        for (size_t i = CHUNK_BLOCKS; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize_);
+            block->next = freeList_;
+            freeList_ = block;
+        }
+    }
+
+    FreeBlock* block = freeList_;
+    freeList_ = block->next;
+    usedBlocks_++;
+    return block;
+}
+
+void BlockPool2D::deallocate(void* block) {
+    auto* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = freeList_;
+    freeList_ = freeBlock;
+    usedBlocks_--;
+}
+
+BlockPool2D& BlockPool2D::forSize(size_t size) {
+    // Leaked on purpose: objects held by static shared pointers are released after static destruction
+    static auto* pools = new std::map<size_t, std::unique_ptr<BlockPool2D>>();
+
+    size_t rounded = (size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+    std::unique_ptr<BlockPool2D>& pool = (*pools)[rounded];
+    if (!pool) pool = std::make_unique<BlockPool2D>(rounded);
+    return *pool;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file Plot2D.cpp
+ * @brief Implementation of the streaming plot series.
+ */
+
+#include "utility/Plot2D.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+// Frames that may be in flight while the CPU writes the next section
+static constexpr size_t RING_SECTIONS = 3;
+
+// Initial section size, in vertices
+static constexpr size_t MIN_SECTION_VERTICES = 4096;
+
+// Below this many points per pixel column the visible range is drawn as is
+static constexpr size_t DECIMATION_POINTS_PER_COLUMN = 4;
+
+// Each instance is a segment (line) or a point (scatter), expanded to a quad
+// in pixel space. The second point of a segment is the next vertex in the
+// buffer, read through a second pair of attributes offset by one vertex.
+static const std::string plotVertexShader = R"(
+    #version 330 core
+    layout(location=0) in vec2 positionA;
+    layout(location=1) in vec4 colorA;
+    layout(location=2) in vec2 positionB;
+    layout(location=3) in vec4 colorB;
+
+    uniform mat3 camera;
+    uniform vec2 viewportSize;
+    uniform float width;        // line width or point diameter, in pixels
+    uniform int scatter;
+
+    out vec2 localPos;          // pixels, relative to the segment center
+    flat out float halfLength;
+    out vec4 vColor;
+
+    void main() {
+        vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+        vec2 toPixels = viewportSize * 0.5;
+        float radius = width * 0.5 + 1.0;  // 1 pixel for the antialiased edge
+
+        vec2 a = (camera * vec3(positionA, 1.0)).xy * toPixels;
+        vec2 b = scatter == 1 ? a : (camera * vec3(positionB, 1.0)).xy * toPixels;
+
+        vec2 direction = b - a;
+        float len = length(direction);
+        direction = len > 1e-6 ? direction / len : vec2(1.0, 0.0);
+        vec2 normal = vec2(-direction.y, direction.x);
+
+        halfLength = len * 0.5;
+        localPos = vec2(corner.x * (halfLength + radius), corner.y * radius);
+        vec2 position = (a + b) * 0.5 + direction * localPos.x + normal * localPos.y;
+
+        vColor = scatter == 1 ? colorA : mix(colorA, colorB, corner.x * 0.5 + 0.5);
+        gl_Position = vec4(position / toPixels, 0.0, 1.0);
+    }
+)";
+
+// Capsule distance: round caps double as round joins between segments
+static const std::string plotFragmentShader = R"(
+    #version 330 core
+    layout(location=0) out vec4 fragColor;
+
+    in vec2 localPos;
+    flat in float halfLength;
+    in vec4 vColor;
+
+    uniform float width;
+
+    void main() {
+        vec2 q = vec2(max(abs(localPos.x) - halfLength, 0.0), localPos.y);
+        float d = length(q) - width * 0.5;
+        float coverage = clamp(0.5 - d, 0.0, 1.0);
+        if (coverage <= 0.0) discard;
+        fragColor = vec4(vColor.rgb, vColor.a * coverage);
+    }
+)";
+
+PlotSeries2D::PlotSeries2D(Style style) : style_(style) {
+    shader_ = std::make_shared<Shader>(plotVertexShader, plotFragmentShader);
+    GL_TRY(glGenVertexArrays(1, &vertex_array_index));
+    createRing(MIN_SECTION_VERTICES * sizeof(PlotVertex2D));
+}
+
+PlotSeries2D::~PlotSeries2D() {
+    destroyRing();
+    glDeleteVertexArrays(1, &vertex_array_index);
+}
+
+//------------------------------------------------------------------------------
+// Data
+//------------------------------------------------------------------------------
+void PlotSeries2D::append(glm::vec2 point) {
+    if (!values_.empty()) values_.push_back(0.0f);
+    addPoint(point);
+}
+
+void PlotSeries2D::append(glm::vec2 point, float value) {
+    if (values_.size() < points_.size()) values_.resize(points_.size(), 0.0f);
+    values_.push_back(value);
+    addPoint(point);
+}
+
+void PlotSeries2D::append(const glm::vec2* points, size_t count, const float* values) {
+    points_.reserve(points_.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        if (values) append(points[i], values[i]);
+        else append(points[i]);
+    }
+}
+
+void PlotSeries2D::clear() {
+    points_.clear();
+    values_.clear();
+    minIndex_.clear();
+    maxIndex_.clear();
+    sorted_ = true;
+}
+
+void PlotSeries2D::setColormap(Colormap colormap, float minValue, float maxValue) {
+    colormap_ = colormap;
+    minValue_ = minValue;
+    maxValue_ = maxValue;
+    useColormap_ = true;
+}
+
+void PlotSeries2D::addPoint(glm::vec2 point) {
+    if (!points_.empty() && point.x < points_.back().x) sorted_ = false;
+    points_.push_back(point);
+
+    // Close every pyramid block that ends with this point
+    size_t count = points_.size();
+    for (size_t level = 0; count % (size_t(2) << level) == 0; level++) {
+        if (level == minIndex_.size()) {
+            minIndex_.emplace_back();
+            maxIndex_.emplace_back();
+        }
+
+        uint32_t minA, minB, maxA, maxB;
+        if (level == 0) {
+            minA = maxA = uint32_t(count - 2);
+            minB = maxB = uint32_t(count - 1);
+        } else {
+            size_t child = minIndex_[level - 1].size() - 2;
+            minA = minIndex_[level - 1][child];
+            minB = minIndex_[level - 1][child + 1];
+            maxA = maxIndex_[level - 1][child];
+            maxB = maxIndex_[level - 1][child + 1];
+        }
+        minIndex_[level].push_back(points_[minB].y < points_[minA].y ? minB : minA);
+        maxIndex_[level].push_back(points_[maxB].y > points_[maxA].y ? maxB : maxA);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Decimation
+//------------------------------------------------------------------------------
+void PlotSeries2D::emit(size_t index) {
+    glm::vec4 color = color_;
+    if (useColormap_ && !values_.empty()) {
+        float range = maxValue_ - minValue_;
+        float t = range != 0.0f ? (values_[index] - minValue_) / range : 0.0f;
+        color = Material::getColor(colormap_, t, color_.a);
+    }
+    frameVertices_.push_back({points_[index], color});
+}
+
+void PlotSeries2D::emitRange(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) emit(i);
+}
+
+void PlotSeries2D::emitMinMax(size_t begin, size_t end) {
+    auto minI = uint32_t(begin);
+    auto maxI = uint32_t(begin);
+
+    // Aligned blocks of the pyramid, single points at the unaligned ends
+    size_t i = begin;
+    while (i < end) {
+        size_t level = 0;
+        while (level < minIndex_.size() && i % (size_t(2) << level) == 0 && i + (size_t(2) << level) <= end) {
+            level++;
+        }
+
+        uint32_t blockMin, blockMax;
+        size_t step;
+        if (level == 0) {
+            blockMin = blockMax = uint32_t(i);
+            step = 1;
+        } else {
+            size_t block = i >> level;
+            blockMin = minIndex_[level - 1][block];
+            blockMax = maxIndex_[level - 1][block];
+            step = size_t(1) << level;
+        }
+
+        if (points_[blockMin].y < points_[minI].y) minI = blockMin;
+        if (points_[blockMax].y > points_[maxI].y) maxI = blockMax;
+        i += step;
+    }
+
+    // Keep the original order so the polyline follows the signal
+    emit(std::min(minI, maxI));
+    if (minI != maxI) emit(std::max(minI, maxI));
+}
+
+void PlotSeries2D::collectVisible(float minX, float maxX, int columns) {
+    frameVertices_.clear();
+    if (points_.empty()) return;
+
+    if (!sorted_) {
+        emitRange(0, points_.size());
+        return;
+    }
+
+    auto byX = [](const glm::vec2& p, float x) { return p.x < x; };
+    size_t begin = std::lower_bound(points_.begin(), points_.end(), minX, byX) - points_.begin();
+    size_t end = std::lower_bound(points_.begin() + begin, points_.end(), maxX, byX) - points_.begin();
+
+    // One point beyond each side keeps the line running to the frame edges
+    if (begin > 0) begin--;
+    if (end < points_.size()) end++;
+
+    // Min/max per column only keeps the outline of a line, a scatter plot needs all its points
+    if (style_ == Style::Scatter || columns <= 0 || end - begin <= size_t(columns) * DECIMATION_POINTS_PER_COLUMN) {
+        emitRange(begin, end);
+        return;
+    }
+
+    emit(begin);
+    float columnWidth = (maxX - minX) / float(columns);
+    size_t first = begin + 1;
+    size_t last = end - 1;
+    for (int column = 0; column < columns && first < last; column++) {
+        float columnEnd = minX + float(column + 1) * columnWidth;
+        size_t next = column == columns - 1 ? last :
+                      std::lower_bound(points_.begin() + first, points_.begin() + last, columnEnd, byX) - points_.begin();
+        if (next > first) emitMinMax(first, next);
+        first = next;
+    }
+    if (last > begin) emit(last);
+}
+
+//------------------------------------------------------------------------------
+// Ring buffer
+//------------------------------------------------------------------------------
+void PlotSeries2D::createRing(size_t sectionBytes) {
+    sectionBytes_ = sectionBytes;
+    section_ = 0;
+    fences_.assign(RING_SECTIONS, nullptr);
+
+    GL_TRY(glBindVertexArray(vertex_array_index));
+    GL_TRY(glGenBuffers(1, &vertexBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+
+    size_t totalBytes = sectionBytes_ * RING_SECTIONS;
+    // The ring is drawn from a base instance, so it also needs GL 4.2 / ARB_base_instance
+    bool baseInstance = GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance;
+    if (GLAD_GL_VERSION_4_4 || (GLAD_GL_ARB_buffer_storage && baseInstance)) {
+        // Written by the CPU while the GPU reads the other sections, no remapping
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GL_TRY(glBufferStorage(GL_ARRAY_BUFFER, (GLsizeiptr) totalBytes, nullptr, flags));
+        mapped_ = glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr) totalBytes, flags);
+    } else {
+        GL_TRY(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) sectionBytes_, nullptr, GL_STREAM_DRAW));
+        mapped_ = nullptr;
+    }
+
+    // Point A is vertex i, point B is vertex i + 1; both advance once per instance
+    auto stride = (GLsizei) sizeof(PlotVertex2D);
+    for (GLuint pair = 0; pair < 2; pair++) {
+        size_t base = pair * sizeof(PlotVertex2D);
+        GL_TRY(glEnableVertexAttribArray(pair * 2));
+        GL_TRY(glVertexAttribPointer(pair * 2, 2, GL_FLOAT, GL_FALSE, stride,
+                                     (void*) (base + offsetof(PlotVertex2D, position))));
+        GL_TRY(glVertexAttribDivisor(pair * 2, 1));
+        GL_TRY(glEnableVertexAttribArray(pair * 2 + 1));
+        GL_TRY(glVertexAttribPointer(pair * 2 + 1, 4, GL_FLOAT, GL_FALSE, stride,
+                                     (void*) (base + offsetof(PlotVertex2D, color))));
+        GL_TRY(glVertexAttribDivisor(pair * 2 + 1, 1));
+    }
+    GL_TRY(glBindVertexArray(0));
+}
+
+void PlotSeries2D::destroyRing() {
+    for (void*& fence: fences_) {
+        if (fence) glDeleteSync((GLsync) fence);
+        fence = nullptr;
+    }
+    if (mapped_) {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped_ = nullptr;
+    }
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexBuffer = 0;
+}
+
+// Writes the visible vertices (plus a copy of the last one, read as point B of
+// the last instance) and returns the index of the first one in the buffer.
+size_t PlotSeries2D::upload() {
+    size_t bytes = (frameVertices_.size() + 1) * sizeof(PlotVertex2D);
+    if (bytes > sectionBytes_) {
+        destroyRing();
+        createRing(std::max(bytes, sectionBytes_ * 2));
+    }
+    frameVertices_.push_back(frameVertices_.back());
+
+    if (!mapped_) {
+        // Orphan the previous storage so the driver does not wait for the last draw
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) sectionBytes_, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) bytes, frameVertices_.data());
+        frameVertices_.pop_back();
+        return 0;
+    }
+
+    section_ = (section_ + 1) % RING_SECTIONS;
+    if (fences_[section_]) {
+        // Only blocks when the GPU is more than RING_SECTIONS - 1 frames behind
+        auto fence = (GLsync) fences_[section_];
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        fences_[section_] = nullptr;
+    }
+
+    size_t offset = section_ * sectionBytes_;
+    std::memcpy(static_cast<char*>(mapped_) + offset, frameVertices_.data(), bytes);
+    frameVertices_.pop_back();
+    return offset / sizeof(PlotVertex2D);
+}
+
+//------------------------------------------------------------------------------
+// Draw
+//------------------------------------------------------------------------------
+void PlotSeries2D::draw(const glm::mat3& camera, const glm::mat3& inverseCamera, glm::vec2 viewportSize) {
+    if (!visible_ || points_.empty() || viewportSize.x <= 0.0f || viewportSize.y <= 0.0f) {
+        frameVertices_.clear();
+        return;
+    }
+
+    // Visible x range of the frame
+    float minX = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    for (glm::vec2 corner: {glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1)}) {
+        float x = (inverseCamera * glm::vec3(corner, 1.0f)).x;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+    }
+
+    collectVisible(minX, maxX, (int) viewportSize.x);
+    if (frameVertices_.empty()) return;
+
+    size_t first = upload();
+    bool scatter = style_ == Style::Scatter;
+    size_t instances = scatter ? frameVertices_.size() : frameVertices_.size() - 1;
+    if (instances == 0) return;
+
+    shader_->setUniform3x3f("camera", camera);
+    shader_->setUniform2f("viewportSize", viewportSize.x, viewportSize.y);
+    shader_->setUniform1f("width", scatter ? pointSize_ : lineWidth_);
+    shader_->setUniform1i("scatter", scatter ? 1 : 0);
+
+    glBindVertexArray(vertex_array_index);
+    if (mapped_) {
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) instances, (GLuint) first);
+    } else {
+        // Orphaned buffer: the points start at 0, no base instance needed
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) instances);
+    }
+    glBindVertexArray(0);
+
+    if (mapped_) fences_[section_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file QualityGovernor.cpp
+ * @brief Implementation of the quality governor.
+ */
+
+#include "utility/QualityGovernor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace Uniforms {
+
+void QualityGovernor::update(double gpuFrameTimeMs, bool interacting, double deltaTime) {
+    if (!enabled_) {
+        level_ = 1.0f;
+        return;
+    }
+
+    idleTime_ = interacting ? 0.0 : idleTime_ + deltaTime;
+
+    // Idle: go straight back to full quality for stills
+    if (idleTime_ >= idleDelay_) {
+        level_ = 1.0f;
+        return;
+    }
+
+    if (gpuFrameTimeMs <= 0.0) {
+        return;  // No measurement yet
+    }
+
+    // Loop-bound shaders scale roughly linearly with iteration counts, so aim for
+    // level * (budget / measured). The measurement lags a frame or two, hence smoothing.
+    float desired = level_ * targetFrameTimeMs_ / static_cast<float>(gpuFrameTimeMs);
+    desired = std::clamp(desired, minLevel_, 1.0f);
+    level_ += (desired - level_) * smoothing_;
+}
+
+void QualityGovernor::apply(UniformCollection& collection) {
+    applied_ = false;
+    if (level_ >= 1.0f) {
+        return;
+    }
+
+    savedFloats_.clear();
+    savedInts_.clear();
+    for (auto& uniformVariant : collection.uniforms) {
+        std::visit([this](auto& u) {
+            using T = std::decay_t<decltype(u)>;
+            if constexpr (std::is_same_v<T, FloatUniform>) {
+                if (!u.quality) return;
+                savedFloats_.push_back(u.value);
+                u.value = u.minValue + (u.value - u.minValue) * level_;
+            }
+            else if constexpr (std::is_same_v<T, IntUniform>) {
+                if (!u.quality) return;
+                savedInts_.push_back(u.value);
+                u.value = u.minValue + static_cast<int>(std::lround((u.value - u.minValue) * level_));
+            }
+        }, uniformVariant);
+    }
+    applied_ = true;
+}
+
+void QualityGovernor::restore(UniformCollection& collection) {
+    if (!applied_) {
+        return;
+    }
+
+    size_t floatIndex = 0;
+    size_t intIndex = 0;
+    for (auto& uniformVariant : collection.uniforms) {
+        std::visit([this, &floatIndex, &intIndex](auto& u) {
+            using T = std::decay_t<decltype(u)>;
+            if constexpr (std::is_same_v<T, FloatUniform>) {
+                if (u.quality) u.value = savedFloats_[floatIndex++];
+            }
+            else if constexpr (std::is_same_v<T, IntUniform>) {
+                if (u.quality) u.value = savedInts_[intIndex++];
+            }
+        }, uniformVariant);
+    }
+    applied_ = false;
+}
+
+} // namespace Uniforms
@@ -0,0 +1,31 @@
+/**
+ * @file RedrawThrottle.cpp
+ * @brief Implementation of the UI redraw throttle.
+ */
+
+#include "utility/RedrawThrottle.h"
+
+#include <algorithm>
+
+void RedrawThrottle::requestRedraw(int frames) {
+    pendingFrames_ = std::max(pendingFrames_, frames);
+}
+
+void RedrawThrottle::watchRevision(uint64_t revision) {
+    if (revision == revision_) return;
+    revision_ = revision;
+    requestRedraw();
+}
+
+bool RedrawThrottle::shouldRedraw(double now) {
+    if (pendingFrames_ == 0 && now - lastRedraw_ < IDLE_INTERVAL) return false;
+
+    pendingFrames_ = std::max(pendingFrames_ - 1, 0);
+    lastRedraw_ = now;
+    return true;
+}
+
+double RedrawThrottle::timeUntilRedraw(double now) const {
+    if (pendingFrames_ > 0) return 0.0;
+    return std::max(lastRedraw_ + IDLE_INTERVAL - now, 0.0);
+}
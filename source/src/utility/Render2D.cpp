@@ -12,10 +12,20 @@
  */
 
 #include "utility/Layer2D.h"
+#include "utility/Batch2D.h"
+#include "utility/SceneGraph2D.h"
+#include "utility/Triangulate2D.h"
+#include "utility/Plot2D.h"
+#include "utility/GeometryRegistry2D.h"
+#include "utility/RenderQueue2D.h"
+#include "utility/RenderThread.h"
 #include <cmath>
+#include <cstdint>
 #include <string>
 #include <format>
 #include <utility>
+#include <algorithm>
+#include <limits>
 
 // M_PI is not defined in MSVC by default
 #ifndef M_PI
@@ -38,6 +48,7 @@ std::string vertexShader = R"(
 
     uniform mat3 camera;
     uniform mat3 transform;
+    uniform float depth;    // per-object depth of the render queue, 0 otherwise
 
     out vec2 fragCoord;
     out vec2 ndcCoord;
@@ -46,7 +57,7 @@ std::string vertexShader = R"(
        fragCoord = position.xy;
        vec3 tr_position = camera * transform * vec3(position.xy, 1.0);
        ndcCoord = tr_position.xy;
-       gl_Position = vec4(tr_position.xy, 0.0, tr_position.z);
+       gl_Position = vec4(tr_position.xy, depth * tr_position.z, tr_position.z);
     }
 )";
 
@@ -75,6 +86,31 @@ std::string fragmentShader =R"(
     }
 )";
 
+// Composite pass of a cached layer: fullscreen triangle from gl_VertexID, premultiplied alpha
+static const std::string compositeVertexShader = R"(
+    #version 330 core
+    uniform vec2 uvScale;     // active area of the layer texture
+    out vec2 uv;
+
+    void main() {
+        vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        uv = corner * uvScale;
+        gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+static const std::string compositeFragmentShader = R"(
+    #version 330 core
+    uniform sampler2D layerTexture;
+
+    in vec2 uv;
+    out vec4 fragColor;
+
+    void main() {
+        fragColor = texture(layerTexture, uv);
+    }
+)";
+
 // Global shader initialization.
 std::shared_ptr<Shader> Shaders::flatShader = nullptr;
 
@@ -128,9 +164,13 @@ void Material::setHighlight(float highlight) {
 }
 
 glm::vec4 Material::getColorViridis(float value, float alpha) {
-    if (value <= 0.0) value = 0.0;
+    return getColor(Colormap::Viridis, value, alpha);
+}
+
+glm::vec4 Material::getColor(Colormap colormap, float value, float alpha) {
+    if (!(value > 0.0)) value = 0.0;    // also NaN
     if (value > 1.0) value = 1.0;
-    unsigned char* rgb = ColormapTables::viridis_table[(size_t)(value * 511)];
+    const unsigned char* rgb = ColormapTables::getTable(colormap)[(size_t)(value * 511)];
     glm::vec4 res = {float(rgb[0])/255.0f, float(rgb[1])/255.0f, float(rgb[2])/255.0f, alpha};
     return res;
 }
@@ -139,7 +179,7 @@ glm::vec4 Material::getColorViridis(float value, float alpha) {
 
 
 //region ------------------------------- KiwiFrame ----------------------------
-KiwiFrame::KiwiFrame() {
+KiwiFrame::KiwiFrame(bool transparent, bool depth) : transparent_(transparent) {
     // set up the buffers
     {
         GL_TRY(glGenFramebuffers(1, &frameBufferObject));
@@ -147,25 +187,22 @@ KiwiFrame::KiwiFrame() {
         // Generate one texture and store its ID in 'textureId' and bind it to 2D texture.
         GL_TRY(glGenTextures(1, &textureId));
         GL_TRY(glBindTexture(GL_TEXTURE_2D, textureId));
-
-        // set the dimensions right (and keep updating them later)
-        GL_TRY(glViewport(0, 0, frameSize.x, frameSize.y));
-
-        // Define and allocate memory for the texture parameters.
-        GL_TRY(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (int) frameSize.x, (int) frameSize.y, 0, GL_RGB, GL_UNSIGNED_BYTE,
-                            nullptr));
         GL_TRY(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));   // Set minifying filter to linear.
         GL_TRY(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));   // Set magnifying filter to linear.
 
         // Create a Renderbuffer Object for Depth Testing
-        GL_TRY(glGenRenderbuffers(1, &renderBufferObject));
-        GL_TRY(glBindRenderbuffer(GL_RENDERBUFFER, renderBufferObject));
-        GL_TRY(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (int) frameSize.x, (int) frameSize.y));
-        GL_TRY(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+        if (depth) GL_TRY(glGenRenderbuffers(1, &renderBufferObject));
 
-        // Attach the Renderbuffer Object to the Framebuffer
+        // set the dimensions right (and keep updating them later)
+        allocate((int) frameSize.x, (int) frameSize.y);
+        GL_TRY(glViewport(0, 0, frameSize.x, frameSize.y));
+
+        // Attach once: reallocating the storage keeps the attachments
         GL_TRY(glBindFramebuffer(GL_FRAMEBUFFER, frameBufferObject));
-        GL_TRY(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderBufferObject));
+        GL_TRY(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0));
+        if (renderBufferObject) {
+            GL_TRY(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderBufferObject));
+        }
 
         // Check if framebuffer is complete
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -185,31 +222,78 @@ KiwiFrame::~KiwiFrame() {
     if (renderBufferObject != 0) glDeleteRenderbuffers(1, &renderBufferObject);
 }
 
-void KiwiFrame::resize(int width, int height) {
-    if (width == 0 || height == 0) return; // Handle minimization case
+// Round up to the next bucket
+static int bucketSize(int size) {
+    return (size + KiwiFrame::SIZE_BUCKET - 1) / KiwiFrame::SIZE_BUCKET * KiwiFrame::SIZE_BUCKET;
+}
 
-    frameSize = {width, height};
+void KiwiFrame::allocate(int width, int height) {
+    allocatedSize_ = {bucketSize(width), bucketSize(height)};
 
     // Reallocate texture
     glBindTexture(GL_TEXTURE_2D, textureId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, transparent_ ? GL_RGBA8 : GL_RGB, (int) allocatedSize_.x, (int) allocatedSize_.y, 0,
+                 GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
 
     // Reallocate renderbuffer storage
-    glBindRenderbuffer(GL_RENDERBUFFER, renderBufferObject);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    if (renderBufferObject) {
+        glBindRenderbuffer(GL_RENDERBUFFER, renderBufferObject);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (int) allocatedSize_.x, (int) allocatedSize_.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+}
+
+void KiwiFrame::resize(int width, int height) {
+    if (width <= 0 || height <= 0) return; // Handle minimization case
+
+    frameSize = {width, height};
+
+    // Only reallocate when the active area outgrows the texture or uses well under half of it
+    bool grow = frameSize.x > allocatedSize_.x || frameSize.y > allocatedSize_.y;
+    bool shrink = 2 * bucketSize(width) <= allocatedSize_.x && 2 * bucketSize(height) <= allocatedSize_.y;
+    if (grow || shrink) allocate(width, height);
 
     // Update viewport
     glViewport(0, 0, width, height);
 }
-void KiwiFrame::bind() const {
-    // Set up the framebuffer and texture for drawing.
-    // Attach the texture to the framebuffer.
+
+void KiwiFrame::setDepthBuffer(bool depth) {
+    if (depth == (renderBufferObject != 0)) return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBufferObject);
+    if (depth) {
+        glGenRenderbuffers(1, &renderBufferObject);
+        glBindRenderbuffer(GL_RENDERBUFFER, renderBufferObject);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, (int) allocatedSize_.x, (int) allocatedSize_.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderBufferObject);
+    } else {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, 0);
+        glDeleteRenderbuffers(1, &renderBufferObject);
+        renderBufferObject = 0;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void KiwiFrame::bind(bool clear) const {
+    // Set up the framebuffer for drawing (the texture is attached since construction)
     glBindFramebuffer(GL_FRAMEBUFFER, frameBufferObject);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureId, 0);
 
     // update the dimension, so the aspect is correct when the user changes the window size
     glViewport(0, 0, (int) frameSize.x, (int) frameSize.y);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (!clear) return;
+
+    GLbitfield clearMask = renderBufferObject ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT;
+    if (transparent_) {
+        GLfloat clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(clearMask);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        return;
+    }
+    glClear(clearMask);
 }
 void KiwiFrame::unbind() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -245,9 +329,16 @@ void KiwiFrame::saveFrameAsImage(const std::string &filename) {
 
 //region -------------------------------- KiwiCore ----------------------------
 
-KiwiCore::KiwiCore() {
+KiwiCore::KiwiCore() : viewSize_(frame.size()) {
     // initialize OpenGL globals
     Shaders::flatShader = std::make_shared<Shader>(vertexShader, fragmentShader);
+
+    compositeShader_ = std::make_shared<Shader>(compositeVertexShader, compositeFragmentShader);
+    GL_TRY(glGenVertexArrays(1, &compositeVertexArray_));
+}
+
+KiwiCore::~KiwiCore() {
+    glDeleteVertexArrays(1, &compositeVertexArray_);
 }
 
 void KiwiCore::addLayer(std::shared_ptr<KiwiLayer> layer) {
@@ -256,20 +347,156 @@ void KiwiCore::addLayer(std::shared_ptr<KiwiLayer> layer) {
 
 
 
+void KiwiCore::setViewSize(float width, float height) {
+    if (viewSize_.x == width && viewSize_.y == height) return;
+    viewSize_ = {width, height};
+    for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        layer->getCamera().setAspectRatio(width, height);
+    }
+}
+
 void KiwiCore::renderFrame(float width, float height, double time, double deltaTime) {
     // Check if the size has changed
-    if (frame.size().x != width || frame.size().y != height) {    // TODO better checking
+    setViewSize(width, height);
+    // Until the thread finished its first frame, the last frame drawn here is shown
+    threadedFrame_ = submitFrame(width, height, time, deltaTime) && renderThread_->acquireFrame();
+    if (threadedFrame_) {
+        onRender(width, height, time, deltaTime);
+        return;
+    }
+
+    if (frame.size() != viewSize_) {
         frame.resize((int)width, (int)height);
-        for (const std::shared_ptr<KiwiLayer>& layer: layers) {
-            layer->getCamera().setAspectRatio(width, height);
-        }
     }
+    // Layers drawn straight into the frame decide whether it needs a depth buffer
+    bool depth = false;
+    for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        depth = depth || (!layer->cached_ && layer->needsDepthBuffer());
+    }
+    frame.setDepthBuffer(depth);
+
     frame.bind();
     for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        if (layer->cached_) {
+            renderCachedLayer(*layer, width, height, time, deltaTime);
+            continue;
+        }
+        layer->cache_.reset();
+        layer->dirty_ = false;
         layer->render(width, height, time, deltaTime);
     }
     frame.unbind();
+    onRender(width, height, time, deltaTime);
+}
+
+bool KiwiCore::needsRender() const {
+    return std::any_of(layers.begin(), layers.end(), [](const std::shared_ptr<KiwiLayer>& layer) {
+        return layer->needsRender();
+    });
+}
 
+bool KiwiCore::submitFrame(float width, float height, double time, double deltaTime) {
+    if (!renderThread_ || !renderThread_->isRunning()) return false;
+    setViewSize(width, height);
+    return submitToRenderThread(width, height, time, deltaTime);
+}
+
+bool KiwiCore::submitToRenderThread(float width, float height, double time, double deltaTime) {
+    for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        if (layer->cached_ || !layer->supportsRenderThread()) return false;
+    }
+
+    RenderJob job;
+    job.width = (int) width;
+    job.height = (int) height;
+    std::vector<std::function<void()>> draws;
+    for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        layer->cache_.reset();
+        layer->dirty_ = false;
+        job.depth = job.depth || layer->needsDepthBuffer();
+        draws.push_back(layer->captureRenderJob(*renderThread_, width, height, time, deltaTime));
+    }
+    job.draw = [draws = std::move(draws)]() {
+        for (const std::function<void()>& draw: draws) {
+            if (draw) draw();
+        }
+    };
+    renderThread_->submit(std::move(job));
+    return true;
+}
+
+void *KiwiCore::getTextureId() const {
+    if (threadedFrame_) return reinterpret_cast<void *>(static_cast<uintptr_t>(renderThread_->getFrameTexture()));
+    return frame.getTextureId();
+}
+
+glm::vec2 KiwiCore::getTextureUVScale() const {
+    return threadedFrame_ ? renderThread_->getFrameUVScale() : frame.getUVScale();
+}
+
+void KiwiCore::renderFrameToScreen(int width, int height, double time, double deltaTime) {
+    bool anyCached = std::any_of(layers.begin(), layers.end(), [](const std::shared_ptr<KiwiLayer>& layer) {
+        return layer->cached_;
+    });
+
+    // Cached layers are composited through the frame: copy it with a blit instead of a sampling pass
+    if (anyCached) {
+        renderFrame((float) width, (float) height, time, deltaTime);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, frame.getFramebuffer());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return;
+    }
+
+    // Otherwise the layers draw into the default framebuffer like into the frame
+    setViewSize((float) width, (float) height);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    for (const std::shared_ptr<KiwiLayer>& layer: layers) {
+        layer->cache_.reset();
+        layer->dirty_ = false;
+        layer->render((float) width, (float) height, time, deltaTime);
+    }
+}
+
+void KiwiCore::renderCachedLayer(KiwiLayer& layer, float width, float height, double time, double deltaTime) {
+    if (!layer.cache_) {
+        layer.cache_ = std::make_shared<KiwiFrame>(true, layer.needsDepthBuffer());
+        layer.dirty_ = true;
+    }
+    KiwiFrame& cache = *layer.cache_;
+    if (cache.size() != frame.size()) {
+        cache.resize((int) frame.size().x, (int) frame.size().y);
+        layer.dirty_ = true;
+    }
+
+    if (layer.needsRender()) {
+        layer.dirty_ = false;   // before rendering, so that the layer can invalidate itself again
+        cache.bind();
+
+        // Colors end up premultiplied by alpha, so compositing matches drawing the layer directly
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        layer.render(width, height, time, deltaTime);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        frame.bind(false);
+    }
+
+    // Layers may have switched programs without going through Shader
+    Shader::invalidateBinding();
+    compositeShader_->bind();
+    compositeShader_->setUniform1i("layerTexture", 0);
+    glm::vec2 uvScale = cache.getUVScale();
+    compositeShader_->setUniform2f("uvScale", uvScale.x, uvScale.y);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, cache.getTexture());
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glBindVertexArray(compositeVertexArray_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void KiwiCore::pollEvents(glm::vec2 windowPos, glm::vec2 mousePos, InputState inputState) {
@@ -314,6 +541,13 @@ void KiwiCore::pollEvents(glm::vec2 windowPos, glm::vec2 mousePos, InputState in
 
 }
 
+void KiwiCore::latchMousePosition(glm::vec2 windowPos, glm::vec2 mousePos) {
+    calcNormalizedMousePos(windowPos, mousePos);
+    for (auto & layer : layers) {
+        layer->updateMousePosition(state.normalizedMousePos);
+    }
+}
+
 void KiwiCore::calcNormalizedMousePos(glm::vec2 windowPos, glm::vec2 mousePos){
     // TODO this is common all layers
     glm::vec2 frameTopLeftPos = glm::vec2(windowPos.x, windowPos.y);
@@ -337,37 +571,183 @@ void KiwiCore::calcNormalizedMousePos(glm::vec2 windowPos, glm::vec2 mousePos){
 //region ------------------------------ KiwiLayer2D ---------------------------
 
 void KiwiLayer2D::render(float windowWidth, float windowHeight, double time, double deltaTime) {
+    // Other layers and ImGui switch programs without going through Shader
+    Shader::invalidateBinding();
+
+    // Also refreshes the inverse transformation
+    glm::mat3 cameraTransform = camera.getTransformation();
+    grid_.draw(camera.getInverseTransformation(), mouseNormalizedPosition);
+
     Shaders::flatShader->bind();
-    Shaders::flatShader->setUniform3x3f("camera", camera.getTransformation());
+    Shaders::flatShader->setUniform3x3f("camera", cameraTransform);
     Shaders::flatShader->setUniform2f("mousePos", mouseNormalizedPosition.x, mouseNormalizedPosition.y);
 
-    grid_.draw();
+    // Scene graph: refresh dirty transforms, then skip everything outside the view
+    SceneNode2D* scene = scene_.get();
+    glm::vec4 view{};
+    if (scene) {
+        scene->update();
+        view = getViewBounds();
+        *sceneStats_ = {};
+    }
+
+    if (!batchingEnabled_ && sortingEnabled_) {
+        if (!queue_) queue_ = std::make_shared<RenderQueue2D>();
+
+        queue_->begin();
+        for (const std::shared_ptr<Object2D>& obj: drawList) {
+            obj->appendToQueue(*queue_, obj->transform);
+        }
+        if (scene) {
+            RenderQueue2D& queue = *queue_;
+            scene->traverse(view, [&queue](Object2D& obj, const glm::mat3& model) {
+                obj.appendToQueue(queue, model);
+            }, *sceneStats_);
+        }
+        queue_->end();
 
+        renderPlots(cameraTransform, {windowWidth, windowHeight});
+        return;
+    }
+
+    if (!batchingEnabled_) {
+        for (const std::shared_ptr<Object2D>& obj: drawList) {
+            Shaders::flatShader->setUniform3x3f("transform", obj->transform);
+            obj->draw();
+        }
+        if (scene) {
+            scene->traverse(view, [](Object2D& obj, const glm::mat3& model) {
+                Shaders::flatShader->setUniform3x3f("transform", model);
+                obj.draw();
+            }, *sceneStats_);
+        }
+        renderPlots(cameraTransform, {windowWidth, windowHeight});
+        return;
+    }
+
+    if (!batch_) batch_ = std::make_shared<BatchRenderer2D>();
+
+    batch_->begin(cameraTransform, mouseNormalizedPosition);
     for (const std::shared_ptr<Object2D>& obj: drawList) {
-        Shaders::flatShader->setUniform3x3f("transform", obj->transform);
-        obj->draw();
+        batch_->submit(*obj, obj->transform);
+    }
+    if (scene) {
+        BatchRenderer2D& batch = *batch_;
+        scene->traverse(view, [&batch](Object2D& obj, const glm::mat3& model) {
+            batch.submit(obj, model);
+        }, *sceneStats_);
     }
+    batch_->end();
+
+    renderPlots(cameraTransform, {windowWidth, windowHeight});
+}
+
+void KiwiLayer2D::renderPlots(const glm::mat3& cameraTransform, glm::vec2 viewportSize) {
+    renderedPlotPoints_ = 0;
+    drawnPlotPoints_ = 0;
+    for (const std::shared_ptr<PlotSeries2D>& plot: plots_) {
+        plot->draw(cameraTransform, camera.getInverseTransformation(), viewportSize);
+        renderedPlotPoints_ += plot->size();
+        if (plot->isVisible()) drawnPlotPoints_ += plot->getDrawnPoints();
+    }
+}
+
+void KiwiLayer2D::removePlot(const std::shared_ptr<PlotSeries2D>& plot) {
+    plots_.erase(std::remove(plots_.begin(), plots_.end(), plot), plots_.end());
+    invalidate();
+}
+
+bool KiwiLayer2D::needsRender() {
+    if (KiwiLayer::needsRender() || camera.shouldUpdateTransformation) return true;
+    if (scene_ && scene_->needsUpdate()) return true;
+
+    // Streaming plots: new points since the last render
+    size_t plotPoints = 0;
+    for (const std::shared_ptr<PlotSeries2D>& plot: plots_) plotPoints += plot->size();
+    return plotPoints != renderedPlotPoints_;
+}
+
+glm::vec4 KiwiLayer2D::getViewBounds() const {
+    // Corners of the normalized frame in layer coordinates
+    glm::mat3 inverse = camera.getInverseTransformation();
+    glm::vec4 bounds{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                     std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    for (glm::vec2 corner: {glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1)}) {
+        glm::vec2 p = glm::vec2(inverse * glm::vec3(corner, 1.0f));
+        bounds = {std::min(bounds.x, p.x), std::min(bounds.y, p.y), std::max(bounds.z, p.x), std::max(bounds.w, p.y)};
+    }
+    return bounds;
+}
+
+const std::shared_ptr<SceneNode2D>& KiwiLayer2D::getScene() {
+    if (!scene_) {
+        scene_ = std::make_shared<SceneNode2D>();
+        sceneStats_ = std::make_shared<SceneStats2D>();
+    }
+    return scene_;
+}
+
+const SceneStats2D& KiwiLayer2D::getSceneStats() const {
+    static const SceneStats2D empty{};
+    return sceneStats_ ? *sceneStats_ : empty;
+}
+
+const BatchStats2D& KiwiLayer2D::getBatchStats() const {
+    static const BatchStats2D empty{};
+    return batch_ ? batch_->getStats() : empty;
+}
+
+const RenderQueueStats2D& KiwiLayer2D::getQueueStats() const {
+    static const RenderQueueStats2D empty{};
+    return queue_ ? queue_->getStats() : empty;
 }
 
 void KiwiLayer2D::registerComponent(std::shared_ptr<KiwiComponent2D> component) {
+    invalidate();
+    component->owner = this;
+    component->ownerIndex = components.size();
+    hitTestIndex_.update(components.size(), component->getBoundingBox());
     components.push_back(std::move(component));
 }
 
-KiwiLayer2D::KiwiLayer2D() : grid_(100, 1, 5) {
+void KiwiLayer2D::markComponentDirty(size_t index) {
+    dirtyComponents_.push_back(index);
+}
+
+void KiwiLayer2D::refreshHitTestIndex() {
+    for (size_t index: dirtyComponents_) {
+        hitTestIndex_.update(index, components[index]->getBoundingBox());
+    }
+    dirtyComponents_.clear();
+
+    // `transform` is assigned directly (e.g. dragging), so a moved component is only
+    // noticed by comparing it with the transform of its cached bounds: one matrix
+    // compare per component, the bounds are recomputed for the moved ones only
+    for (size_t index = 0; index < components.size(); index++) {
+        const KiwiComponent2D& component = *components[index];
+        if (component.cachedBoundsTransform == component.transform) continue;
+        hitTestIndex_.update(index, components[index]->getBoundingBox());
+    }
+}
+
+KiwiLayer2D::KiwiLayer2D() : grid_(1, 5) {
     Material::InitializeGlobalMaterials();
     Shaders::flatShader->setUniform3x3f("camera", glm::mat3(1.0));
     Shaders::flatShader->setUniform1f("highlightIntensity", 0.9f);
-    grid_.update(camera.getZoom(), camera.getPosition());
 
 }
 
 void KiwiLayer2D::updateMousePosition(glm::vec2 normalizedPosition) {
+    // The flat shader highlights around the mouse
+    if (normalizedPosition != mouseNormalizedPosition) invalidate();
     mouseNormalizedPosition = normalizedPosition;
     glm::mat3 inverseCameraTransform = camera.getInverseTransformation();
     mousePosition = inverseCameraTransform * glm::vec3(normalizedPosition, 1.0f);
 }
 
 void KiwiLayer2D::handleMouseEvent(MouseEvent mouseEvent) {
+    // Enter is sent every frame while no button is down, moves are handled by updateMousePosition()
+    if (mouseEvent.type != MouseEvent::Type::Enter) invalidate();
 
     if (mouseEvent.type == MouseEvent::Type::MouseWheel) {
 
@@ -380,9 +760,6 @@ void KiwiLayer2D::handleMouseEvent(MouseEvent mouseEvent) {
         float newZoom = 0.000256f * std::pow(5.0f, cam_zoom);                   // reset in linear space
         getCamera().setZoom(newZoom);
         updateMousePosition(mouseNormalizedPosition);
-
-        // Update the grid with the new zoom and camera position
-        getGrid().update(newZoom, camera.getPosition());
         return;
     }
 
@@ -408,7 +785,19 @@ void KiwiLayer2D::handleMouseEvent(MouseEvent mouseEvent) {
         if(onMouseReleaseCallback && !onMouseReleaseCallback(mouseEvent, *this)) return;
     }
 
-    for (const std::shared_ptr<KiwiComponent2D>& comp: components) {
+    // Only components under the cursor, plus those that still need Leave/Release
+    refreshHitTestIndex();
+    hitCandidates_.clear();
+    hitTestIndex_.query(mousePosition, hitCandidates_);
+    hitCandidates_.insert(hitCandidates_.end(), activeComponents_.begin(), activeComponents_.end());
+
+    // Dispatch in registration order, like a full walk would
+    std::sort(hitCandidates_.begin(), hitCandidates_.end());
+    hitCandidates_.erase(std::unique(hitCandidates_.begin(), hitCandidates_.end()), hitCandidates_.end());
+    activeComponents_.clear();
+
+    for (size_t index: hitCandidates_) {
+        const std::shared_ptr<KiwiComponent2D>& comp = components[index];
         glm::vec4 boundingBox = comp->getBoundingBox();
         if (mousePosition.x > boundingBox.x && mousePosition.y > boundingBox.y &&
             mousePosition.x < boundingBox.z && mousePosition.y < boundingBox.a) {
@@ -436,6 +825,9 @@ void KiwiLayer2D::handleMouseEvent(MouseEvent mouseEvent) {
             comp->onMouseEvent(MouseEvent(mousePosition, mouseEvent.type));
         }
 
+        if (comp->isHovering() || comp->isMouseDown()) {
+            activeComponents_.push_back(index);
+        }
     }
 }
 
@@ -443,165 +835,92 @@ void KiwiLayer2D::handleMouseEvent(MouseEvent mouseEvent) {
 
 
 //region ------------------------------- NestGrid2D ---------------------------
-NestGrid2D::NestGrid2D(int size, float spacing, float divisionBy) {
-
-    spacingMajor = spacing;
-    division = divisionBy;
-
-    grid2D = std::make_shared<Grid2D>(Material::createFlatMaterial(
-            glm::vec4(0.3, 0.3, 0.3, 1)), size, spacing);
-    grid2D->getStrokeMaterial()->setHighlight(0.05);
-
-    subGrid2D = std::make_shared<Grid2D>(Material::createFlatMaterial(
-            glm::vec4(0.3, 0.3, 0.3, 1)), size, spacingMajor / division);
-    subGrid2D->getStrokeMaterial()->setHighlight(0.05);
-
-    grid2D->baseSpacing = spacingMajor;
-    subGrid2D->baseSpacing = spacingMajor / division;
-    subGrid2D->flipAlpha = true;
-}
 
-void NestGrid2D::update(float zoomLevel, glm::vec2 cameraPosition) {
-    grid2D->updateGrid(zoomLevel, cameraPosition);
-    subGrid2D->updateGrid(zoomLevel, cameraPosition);
-}
-
-
-void NestGrid2D::draw() {
-    Shaders::flatShader->setUniform3x3f("transform", grid2D->transform);
-    grid2D->draw();
-    subGrid2D->draw();
-}
+// Fullscreen triangle generated from gl_VertexID, mapped to layer coordinates
+static const std::string gridVertexShader = R"(
+    #version 330 core
+    uniform mat3 inverseCamera;
 
+    out vec2 layerCoord;
+    out vec2 ndcCoord;
 
+    void main() {
+        vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+        ndcCoord = ndc;
+        layerCoord = (inverseCamera * vec3(ndc, 1.0)).xy;
+        gl_Position = vec4(ndc, 0.0, 1.0);
+    }
+)";
 
+// Levels are powers of `division` (starting at 2 units of normalized frame height):
+// within a level the major lines fade in while the minor lines fade out, so the
+// minor lines of one level become the major lines of the next without popping.
+static const std::string gridFragmentShader = R"(
+    #version 330 core
+    layout(location=0) out vec4 fragColor;
 
+    in vec2 layerCoord;
+    in vec2 ndcCoord;
 
+    uniform mat3 inverseCamera;
+    uniform float spacing;
+    uniform float division;
+    uniform vec4 iColor;
+    uniform vec2 mousePos;
+    uniform float highlightIntensity;
+
+    // Coverage of a 1 pixel line through every multiple of `step`
+    float gridLine(vec2 p, float step) {
+        vec2 g = p / step;
+        vec2 d = abs(fract(g - 0.5) - 0.5) / max(fwidth(g), vec2(1e-6));
+        return 1.0 - min(min(d.x, d.y), 1.0);
+    }
 
+    void main() {
+        // Layer units covered by one unit of normalized frame height
+        float extent = length(inverseCamera[1].xy);
+        float level = floor(log(extent / 2.0) / log(division));
+        float category = 2.0 * pow(division, level);
+        float fade = clamp((extent - category) / (category * (division - 1.0)), 0.0, 1.0);
 
-//endregion
+        float major = gridLine(layerCoord, category * spacing) * fade;
+        float minor = gridLine(layerCoord, category * spacing / division) * (1.0 - fade);
+        float alpha = max(major, minor) * iColor.a;
+        if (alpha < 1.0 / 255.0) discard;
 
+        float distanceToMouse = distance(ndcCoord, mousePos);
+        float highlightIntensity_ = (1.0 - smoothstep(0.0, 0.25, distanceToMouse)) * highlightIntensity;
+        vec3 lighterColor = clamp(iColor.rgb + 0.5, 0.0, 1.0);
+        fragColor = vec4(mix(iColor.rgb, lighterColor, highlightIntensity_), alpha);
+    }
+)";
 
-//region --------------------------------- Grid2D -----------------------------
+NestGrid2D::NestGrid2D(float spacing, float divisionBy) : spacingMajor(spacing), division(divisionBy) {
+    shader_ = std::make_shared<Shader>(gridVertexShader, gridFragmentShader);
 
-Grid2D::Grid2D(std::shared_ptr<Material> material, int size, float spacing) :
-    MaterialObject2D(std::move(material), std::move(material)),
-    grid_size(size),
-    baseSpacing(spacing)
-{
+    // Core profile needs a bound vertex array even without attributes
     GL_TRY(glGenVertexArrays(1, &vertex_array_index));
-    GL_TRY(glBindVertexArray(vertex_array_index));
-
-    GL_TRY(glGenBuffers(1, &vertexBuffer));
-    // Initial vertex buffer setup with default spacing
-    updateGrid(1.0, {0, 0});
-    updateVertexBuffer();
-
-    // Vertex attribute setup
-    GL_TRY(glEnableVertexAttribArray(0));
-    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
 }
 
-Grid2D::~Grid2D() {
+NestGrid2D::~NestGrid2D() {
     glDeleteVertexArrays(1, &vertex_array_index);
-    glDeleteBuffers(1, &vertexBuffer);
 }
 
-void Grid2D::updateVertexBuffer() {
-    std::vector<float> vertices;
-
-    for (int i = -grid_size; i <= grid_size; ++i) {
-        // Horizontal line
-        vertices.push_back(-grid_size * grid_spacing + origin.x); // x1
-        vertices.push_back(i * grid_spacing + origin.y);          // y1
-        vertices.push_back(grid_size * grid_spacing + origin.x);  // x2
-        vertices.push_back(i * grid_spacing + origin.y);          // y2
-
-        // Vertical line
-        vertices.push_back(i * grid_spacing + origin.x);          // x1
-        vertices.push_back(-grid_size * grid_spacing + origin.y); // y1
-        vertices.push_back(i * grid_spacing + origin.x);          // x2
-        vertices.push_back(grid_size * grid_spacing + origin.y);  // y2
-    }
-
-    // Vertex Buffer setup
-    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
-    GL_TRY(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW));
-
-}
+void NestGrid2D::draw(const glm::mat3& inverseCamera, glm::vec2 mousePosition) {
+    if (!visible_) return;
 
-void Grid2D::draw() {
-    // Store previous settings
-    GLfloat previousLineWidth;
-    glGetFloatv(GL_LINE_WIDTH, &previousLineWidth);
+    shader_->setUniform3x3f("inverseCamera", inverseCamera);
+    shader_->setUniform1f("spacing", spacingMajor);
+    shader_->setUniform1f("division", division);
+    shader_->setUniform4f(UNIFORM_COLOR, color_.r, color_.g, color_.b, color_.a);
+    shader_->setUniform2f("mousePos", mousePosition.x, mousePosition.y);
+    shader_->setUniform1f(UNIFORM_HIGHLIGHT, 0.05f);
 
-    // draw the grid
-//    Shaders::flatShader->bind();
-    MaterialObject2D::strokeMaterial->bind();
     glBindVertexArray(vertex_array_index);
-    glLineWidth(line_width);
-    glDrawArrays(GL_LINES, 0, 4 * grid_size * 2);
-
-    // restore the previous settings
-    glLineWidth(previousLineWidth);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
     glBindVertexArray(0);
 }
 
-void Grid2D::updateGrid(float zoomLevel, glm::vec2 cameraPosition) {
-    // Calculate new grid spacing based on zoomLevel
-    bool mustUpdate = calculateNewSpacing(zoomLevel, cameraPosition);
-
-    // Update the vertex buffer if spacing has changed significantly
-    if (mustUpdate) {
-        updateVertexBuffer();
-    }
-}
-
-bool Grid2D::calculateNewSpacing(float zoomLevel, glm::vec2 cameraPosition) {
-
-    double new_spacing = 0.1;
-    double alpha = 1.0;
-    float zoom_inverse = 1 / zoomLevel;
-
-
-    double division = 5.0f;
-    double curr_category = 1250;
-
-    for (int i = 0; i < 50; ++i) {
-        if (curr_category <= zoom_inverse && zoom_inverse < (curr_category * division)) {
-            new_spacing = curr_category / 2.0f;
-            alpha = (zoom_inverse - curr_category) / ((curr_category * division) - curr_category);
-            break;
-        }
-        curr_category /= division;
-    }
-
-    // update opacity
-    if (flipAlpha) alpha = 1.0f - alpha;
-    strokeMaterial->setAlpha((float)alpha);
-
-    new_spacing = new_spacing * baseSpacing * 2.0f;
-
-    glm::vec2 new_origin = {
-            -std::round(cameraPosition.x / new_spacing) * new_spacing,
-            -std::round(cameraPosition.y / new_spacing) * new_spacing
-    };
-
-    bool result = false;
-
-    if (new_origin != origin) {
-        origin = new_origin;
-        result = true;
-    }
-
-    if (new_spacing != grid_spacing) {
-        grid_spacing = (float)new_spacing;
-        result = true;
-    }
-
-    return result;
-}
-
 //endregion
 
 
@@ -667,6 +986,9 @@ Object::Object() {
     name = std::format("object {}", count);
 }
 
+void Object2D::appendToQueue(RenderQueue2D& queue, const glm::mat3& model) {
+    queue.add(*this, model);
+}
 
 //endregion
 
@@ -682,105 +1004,55 @@ std::shared_ptr<Material> MaterialObject2D::getFillMaterial() const { return fil
 void MaterialObject2D::setStrokeMaterial(std::shared_ptr<Material> mat) { strokeMaterial = std::move(mat); }
 std::shared_ptr<Material> MaterialObject2D::getStrokeMaterial() const { return strokeMaterial; }
 
+const Material* MaterialObject2D::getSortMaterial() const {
+    // Fill and stroke are drawn with one depth, so they have to share the shader
+    if (fillMaterial && strokeMaterial && fillMaterial->getShader() != strokeMaterial->getShader()) return nullptr;
+    return fillMaterial ? fillMaterial.get() : strokeMaterial.get();
+}
+
+bool MaterialObject2D::isTranslucent() const {
+    return (fillMaterial && fillMaterial->getColor().a < 1.0f) || (strokeMaterial && strokeMaterial->getColor().a < 1.0f);
+}
+
 //endregion
 
 
 //region ------------------------------ Rectangle2D ---------------------------
 
 void Rectangle2D::draw() {
-    glBindVertexArray(vertex_array_index);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-
-    // Layout
-    {
-        // Enable vertex attribute array 0.
-        GL_TRY(glEnableVertexAttribArray(0));
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
+    const UnitMesh2D& mesh = GeometryRegistry2D::bindMesh(GeometryRegistry2D::Mesh::Rectangle);
 
-
-//    Shaders::flatShader->bind();
     if (fill_) {
         MaterialObject2D::fillMaterial->bind();
-        GL_TRY(glDrawElements(GL_TRIANGLES, 6 * sizeof(unsigned int), GL_UNSIGNED_INT, nullptr));
+        glDrawArrays(GL_TRIANGLE_FAN, mesh.fillFirst, mesh.fillCount);
     }
 
     if (drawEdges_){
         MaterialObject2D::strokeMaterial->bind();
-        glDrawArrays(GL_LINE_LOOP, 0, 4);
-       // glDrawElements(GL_LINES, 6 * sizeof(unsigned int), GL_UNSIGNED_INT, nullptr);
+        glDrawArrays(GL_LINE_LOOP, mesh.outlineFirst, mesh.outlineCount);
     }
 
-
     glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-Rectangle2D::Rectangle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial)
-    : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)) {
-    GL_TRY(glGenVertexArrays(1, &vertex_array_index));      // Generate a vertex array object.
-    GL_TRY(glBindVertexArray(vertex_array_index));          // Bind the vertex array object.
-
-    // Layout
-    float x1 = -0.5, x2 = 0.5;
-    float y1 = -0.5, y2 = 0.5;
-
-    float vertices[] = {
-            x1, y1,  // Bottom left
-            x2, y1,  // Bottom right
-            x2, y2,  // Top right
-            x1, y2   // Top left
-    };
+bool Rectangle2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    if ((fill_ && !BatchRenderer2D::accepts(fillMaterial)) ||
+        (drawEdges_ && !BatchRenderer2D::accepts(strokeMaterial))) return false;
 
-    unsigned int indices[] = {
-            0, 1, 2,    // First triangle
-            2, 3, 0     // Second triangle
+    static const glm::vec2 corners[] = {
+            {-0.5f, -0.5f},  // Bottom left
+            { 0.5f, -0.5f},  // Bottom right
+            { 0.5f,  0.5f},  // Top right
+            {-0.5f,  0.5f}   // Top left
     };
 
-    // Vertex Buffer setup
-    {
-        GL_TRY(glGenBuffers(1, &vertexBuffer));
-        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
-        GL_TRY(glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(float), vertices, GL_STATIC_DRAW));
-    }
-
-    // Index buffer setup
-    {
-        GL_TRY(glGenBuffers(1, &indexBuffer));
-        GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
-        GL_TRY(glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), indices, GL_STATIC_DRAW));
-    }
-
-    // Vertex attribute setup
-    {
-        GL_TRY(glEnableVertexAttribArray(0));                    // Enable vertex attribute array 0.
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
-
-
+    if (fill_) batch.addTriangleFan(corners, 4, model, *fillMaterial);
+    if (drawEdges_) batch.addLineLoop(corners, 4, model, *strokeMaterial);
+    return true;
 }
 
-Rectangle2D::~Rectangle2D() {
-    glDeleteVertexArrays(1, &vertex_array_index);
-    glDeleteBuffers(1, &vertexBuffer);
-    glDeleteBuffers(1, &indexBuffer);
-}
+Rectangle2D::Rectangle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial)
+    : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)) {}
 
 //endregion
 
@@ -788,117 +1060,52 @@ Rectangle2D::~Rectangle2D() {
 //region -------------------------------- Circle2D ----------------------------
 
 Circle2D::Circle2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial)
-        : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)) {
-    // Generate VAO and VBO, bind them, and set up vertex data
-    GL_TRY(glGenVertexArrays(1, &vertex_array_index));
-    GL_TRY(glBindVertexArray(vertex_array_index));
-
-    // Circle data
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-    {
-        // Center vertex for fan
-        vertices.push_back(0.0f); // x
-        vertices.push_back(0.0f); // y
-
-        // Circle vertices
-        for (int i = 0; i <= num_segments; ++i) {
-            float theta = 2.0f * M_PI * float(i) / float(num_segments);
-            float x = 0.5 * cosf(theta); // Calculate the x component
-            float y = 0.5 * sinf(theta); // Calculate the y component
-            vertices.push_back(x);
-            vertices.push_back(y);
-        }
-
-        // Setting up indices for triangle fan
-        for (unsigned int i = 0; i <= num_segments+1; i++) {
-            indices.push_back(i);
-        }
-    }
-
-    // Vertex Buffer setup
-    {
-        GL_TRY(glGenBuffers(1, &vertexBuffer));
-        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
-        GL_TRY(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW));
-    }
-
-    // Index buffer setup
-    {
-        GL_TRY(glGenBuffers(1, &indexBuffer));
-        GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
-        GL_TRY(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW));
-    }
-
-    // Vertex attribute setup
-    {
-        GL_TRY(glEnableVertexAttribArray(0));                    // Enable vertex attribute array 0.
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
-    GL_TRY(glBindVertexArray(0)); // Unbind VAO
-}
-
+        : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)) {}
 
 void Circle2D::draw() {
-    MaterialObject2D::fillMaterial->bind();
+    const UnitMesh2D& mesh = GeometryRegistry2D::bindMesh(GeometryRegistry2D::Mesh::Circle);
 
-    glBindVertexArray(vertex_array_index);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-
-    // Layout
-    {
-        // Enable vertex attribute array 0.
-        GL_TRY(glEnableVertexAttribArray(0));
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
-
-
-//    Shaders::flatShader->bind();
     if (fill_) {
         MaterialObject2D::fillMaterial->bind();
-        glDrawElements(GL_TRIANGLE_FAN, num_segments + 2, GL_UNSIGNED_INT, nullptr);
+        glDrawArrays(GL_TRIANGLE_FAN, mesh.fillFirst, mesh.fillCount);
     }
 
     if (drawEdges_){
         MaterialObject2D::strokeMaterial->bind();
-        // Start at 1 to skip the center point
-        glDrawArrays(GL_LINE_LOOP, 1, num_segments);
+        glDrawArrays(GL_LINE_LOOP, mesh.outlineFirst, mesh.outlineCount);
     }
 
-
     glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
+bool Circle2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    if ((fill_ && !BatchRenderer2D::accepts(fillMaterial)) ||
+        (drawEdges_ && !BatchRenderer2D::accepts(strokeMaterial))) return false;
 
-    glBindVertexArray(0);
+    // Drawn analytically instead of the tessellated fan, 1 pixel outline like GL_LINE_LOOP
+    batch.addInstance(SdfPrimitive2D::Shape::Circle, 0.0f, 1.0f, model,
+                      fill_ ? fillMaterial.get() : nullptr,
+                      drawEdges_ ? strokeMaterial.get() : nullptr);
+    return true;
 }
 
-Circle2D::~Circle2D() {
-    glDeleteVertexArrays(1, &vertex_array_index);
-    glDeleteBuffers(1, &vertexBuffer);
-    glDeleteBuffers(1, &indexBuffer);
-}
 //endregion
 
 
 //region ------------------------------- Polygon2D ----------------------------
 
+// Twice the signed area of triangle abc, positive when counter-clockwise
+static double cross2D(glm::vec2 a, glm::vec2 b, glm::vec2 c) {
+    return double(b.x - a.x) * (c.y - a.y) - double(b.y - a.y) * (c.x - a.x);
+}
+
+// Segments ab and cd cross in their interiors
+static bool segmentsCross(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d) {
+    double d1 = cross2D(a, b, c), d2 = cross2D(a, b, d);
+    double d3 = cross2D(c, d, a), d4 = cross2D(c, d, b);
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
 Polygon2D::Polygon2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Material> strokeMaterial)
         : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)) {
 
@@ -906,82 +1113,228 @@ Polygon2D::Polygon2D(std::shared_ptr<Material> fillMaterial, std::shared_ptr<Mat
     GL_TRY(glGenVertexArrays(1, &vertex_array_index));
     GL_TRY(glBindVertexArray(vertex_array_index));
 
-    // Generate VBO and IBO
+    // Generate VBO and IBO, their storage is allocated on the first upload
     GL_TRY(glGenBuffers(1, &vertexBuffer));
     GL_TRY(glGenBuffers(1, &indexBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+    GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+
+    // Vertex attribute setup
+    GL_TRY(glEnableVertexAttribArray(0));
+    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+    GL_TRY(glBindVertexArray(0));
+}
 
+void Polygon2D::resetVertices() {
+    vertices.clear();
+    holeStarts.clear();
+    indices.clear();
+    triangulatedVertices_ = 0;
+    retriangulate_ = true;
+    vertexDirtyBegin_ = vertexDirtyEnd_ = 0;
+    indexDirtyBegin_ = 0;
 }
 
 void Polygon2D::addVertex(const glm::vec2& vertex) {
     vertices.push_back(vertex);
+    markVerticesDirty(vertices.size() - 1, vertices.size());
 }
 
+void Polygon2D::beginHole() {
+    holeStarts.push_back(vertices.size());
+    retriangulate_ = true;
+}
 
-void Polygon2D::updateVertices() {
+void Polygon2D::setVertex(size_t index, const glm::vec2& vertex) {
+    if (index >= vertices.size()) return;
+    vertices[index] = vertex;
+    markVerticesDirty(index, index + 1);
+
+    if (retriangulate_ || index >= triangulatedVertices_) return;
+
+    // Keep the triangulation while the triangles around the vertex are still valid ears:
+    // counter-clockwise and without another vertex of the polygon inside. A vertex in no
+    // triangle (dropped as duplicate or collinear) changes the outline the fill misses.
+    bool referenced = false;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        if (indices[t] != index && indices[t + 1] != index && indices[t + 2] != index) continue;
+        referenced = true;
+        glm::vec2 a = vertices[indices[t]], b = vertices[indices[t + 1]], c = vertices[indices[t + 2]];
+        if (cross2D(a, b, c) <= 0.0 || triangleContainsVertex(a, b, c)) {
+            retriangulate_ = true;
+            return;
+        }
+    }
+    if (!referenced) retriangulate_ = true;
+}
 
-    // TODO add first as center of Polygon!
+bool Polygon2D::triangleContainsVertex(glm::vec2 a, glm::vec2 b, glm::vec2 c) const {
+    for (const glm::vec2& p: vertices) {
+        if (p == a || p == b || p == c) continue;
+        if (cross2D(a, b, p) >= 0 && cross2D(b, c, p) >= 0 && cross2D(c, a, p) >= 0) return true;
+    }
+    return false;
+}
 
-    std::vector<unsigned int> indices;
-    for (size_t i = 0; i < vertices.size(); i++) {
-        indices.push_back(i);
+void Polygon2D::markVerticesDirty(size_t begin, size_t end) {
+    if (vertexDirtyBegin_ >= vertexDirtyEnd_) {
+        vertexDirtyBegin_ = begin;
+        vertexDirtyEnd_ = end;
+        return;
     }
+    vertexDirtyBegin_ = std::min(vertexDirtyBegin_, begin);
+    vertexDirtyEnd_ = std::max(vertexDirtyEnd_, end);
+}
 
-    // Update vertex buffer
-    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
-    GL_TRY(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW));
+bool Polygon2D::needsUpdate() const {
+    return retriangulate_ || triangulatedVertices_ != vertices.size() ||
+           vertexDirtyBegin_ < vertexDirtyEnd_ || indexDirtyBegin_ < indices.size();
+}
+
+bool Polygon2D::appendTriangle(size_t vertex) {
+    // Only the outer ring of a polygon without holes grows ear by ear
+    if (!holeStarts.empty() || vertex < 3) return false;
+
+    // The ring of the first `vertex` points is closed by the edge last -> first,
+    // which the new point replaces by last -> point -> first
+    const glm::vec2 last = vertices[vertex - 1];
+    const glm::vec2 first = vertices[0];
+    const glm::vec2 point = vertices[vertex];
+
+    double ringArea = signedArea2D(vertices.data(), vertex);
+    double ear = cross2D(last, point, first);
+    if (ringArea == 0.0 || ear == 0.0 || (ear > 0.0) != (ringArea > 0.0)) return false;
+
+    // The ear must not contain or cross any other part of the ring
+    for (size_t i = 1; i + 1 < vertex; i++) {
+        glm::vec2 p = vertices[i];
+        double s0 = cross2D(last, point, p), s1 = cross2D(point, first, p), s2 = cross2D(first, last, p);
+        bool inside = ear > 0.0 ? (s0 >= 0 && s1 >= 0 && s2 >= 0) : (s0 <= 0 && s1 <= 0 && s2 <= 0);
+        if (inside) return false;
+    }
+    for (size_t i = 0; i + 1 < vertex; i++) {
+        glm::vec2 a = vertices[i], b = vertices[i + 1];
+        if (segmentsCross(a, b, last, point) || segmentsCross(a, b, point, first)) return false;
+    }
+
+    indexDirtyBegin_ = std::min(indexDirtyBegin_, indices.size());
+    auto closing = (unsigned int) (vertex - 1);
+    auto added = (unsigned int) vertex;
+    if (ringArea > 0.0) indices.insert(indices.end(), {closing, added, 0u});
+    else indices.insert(indices.end(), {0u, added, closing});
+    return true;
+}
+
+void Polygon2D::triangulate() {
+    if (!retriangulate_) {
+        while (triangulatedVertices_ < vertices.size()) {
+            if (!appendTriangle(triangulatedVertices_)) {
+                retriangulate_ = true;
+                break;
+            }
+            triangulatedVertices_++;
+        }
+    }
+
+    if (retriangulate_) {
+        triangulatePolygon2D(vertices, holeStarts, indices);
+        triangulatedVertices_ = vertices.size();
+        retriangulate_ = false;
+        indexDirtyBegin_ = 0;
+    }
+}
+
+void Polygon2D::updateVertices() {
+    triangulate();
 
+    // The element buffer binding belongs to this object's vertex array
+    GL_TRY(glBindVertexArray(vertex_array_index));
+
+    // Update vertex buffer
+    vertexDirtyEnd_ = std::min(vertexDirtyEnd_, vertices.size());
+    if (vertexDirtyBegin_ < vertexDirtyEnd_) {
+        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+        if (vertices.size() > vertexCapacity_) {
+            vertexCapacity_ = std::max(vertices.size(), vertexCapacity_ * 2);
+            GL_TRY(glBufferData(GL_ARRAY_BUFFER, vertexCapacity_ * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW));
+            vertexDirtyBegin_ = 0;
+            vertexDirtyEnd_ = vertices.size();
+        }
+        GL_TRY(glBufferSubData(GL_ARRAY_BUFFER, vertexDirtyBegin_ * sizeof(glm::vec2),
+                               (vertexDirtyEnd_ - vertexDirtyBegin_) * sizeof(glm::vec2),
+                               vertices.data() + vertexDirtyBegin_));
+    }
+    vertexDirtyBegin_ = vertexDirtyEnd_ = 0;
 
     // Update index buffer
-    GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
-    GL_TRY(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW));
+    if (indexDirtyBegin_ < indices.size()) {
+        GL_TRY(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
+        if (indices.size() > indexCapacity_) {
+            indexCapacity_ = std::max(indices.size(), indexCapacity_ * 2);
+            GL_TRY(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity_ * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW));
+            indexDirtyBegin_ = 0;
+        }
+        GL_TRY(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexDirtyBegin_ * sizeof(unsigned int),
+                               (indices.size() - indexDirtyBegin_) * sizeof(unsigned int),
+                               indices.data() + indexDirtyBegin_));
+    }
+    indexDirtyBegin_ = indices.size();
 
-    // Vertex attribute setup
-    GL_TRY(glEnableVertexAttribArray(0));
-    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+    GL_TRY(glBindVertexArray(0));
 }
 
 
 void Polygon2D::draw() {
-    MaterialObject2D::fillMaterial->bind();
+    if (needsUpdate()) updateVertices();
 
+    // Buffers and layout are recorded in the vertex array
     glBindVertexArray(vertex_array_index);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-
-    // Layout
-    {
-        // Enable vertex attribute array 0.
-        GL_TRY(glEnableVertexAttribArray(0));
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
 
 //    Shaders::flatShader->bind();
-    if (fill_) {
+    if (fill_ && !indices.empty()) {
         MaterialObject2D::fillMaterial->bind();
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDrawElements(GL_TRIANGLE_FAN, vertices.size(), GL_UNSIGNED_INT, nullptr);
+        glDrawElements(GL_TRIANGLES, (GLsizei) indices.size(), GL_UNSIGNED_INT, nullptr);
     }
 
     if (drawEdges_){
         MaterialObject2D::strokeMaterial->bind();
-        // Start at 1 to skip the center point
-        glDrawArrays(GL_LINE_LOOP, 0, vertices.size());
+        // One loop per ring
+        for (size_t ring = 0; ring <= holeStarts.size(); ring++) {
+            size_t begin = ring == 0 ? 0 : holeStarts[ring - 1];
+            size_t end = ring < holeStarts.size() ? holeStarts[ring] : vertices.size();
+            if (end > begin) glDrawArrays(GL_LINE_LOOP, (GLint) begin, (GLsizei) (end - begin));
+        }
     }
 
-
     glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
 
+bool Polygon2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    if ((fill_ && !BatchRenderer2D::accepts(fillMaterial)) ||
+        (drawEdges_ && !BatchRenderer2D::accepts(strokeMaterial))) return false;
 
-    glBindVertexArray(0);
+    if (fill_) {
+        triangulate();
+        batch.addTriangles(vertices.data(), vertices.size(), indices.data(), indices.size(), model, *fillMaterial);
+    }
+    if (drawEdges_) {
+        for (size_t ring = 0; ring <= holeStarts.size(); ring++) {
+            size_t begin = ring == 0 ? 0 : holeStarts[ring - 1];
+            size_t end = ring < holeStarts.size() ? holeStarts[ring] : vertices.size();
+            batch.addLineLoop(vertices.data() + begin, end - begin, model, *strokeMaterial);
+        }
+    }
+    return true;
+}
+
+glm::vec4 Polygon2D::getLocalBounds() const {
+    glm::vec4 bounds{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                     std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    for (const glm::vec2& v: vertices) {
+        bounds = {std::min(bounds.x, v.x), std::min(bounds.y, v.y), std::max(bounds.z, v.x), std::max(bounds.w, v.y)};
+    }
+    return bounds;
 }
 
 Polygon2D::~Polygon2D() {
@@ -992,71 +1345,146 @@ Polygon2D::~Polygon2D() {
 //endregion
 
 
-//region --------------------------------- Line2D -----------------------------
+//region ---------------------------- SdfPrimitive2D --------------------------
 
-void Line2D::draw() {
+SdfPrimitive2D::SdfPrimitive2D(Shape shape, float parameter, std::shared_ptr<Material> fillMaterial,
+                               std::shared_ptr<Material> strokeMaterial)
+        : MaterialObject2D(std::move(fillMaterial), std::move(strokeMaterial)), shape_(shape), parameter_(parameter) {
+    GL_TRY(glGenVertexArrays(1, &vertex_array_index));
+    GL_TRY(glBindVertexArray(vertex_array_index));
+    GL_TRY(glGenBuffers(1, &vertexBuffer));
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+
+    // Vertex attribute setup
+    GL_TRY(glEnableVertexAttribArray(0));
+    GL_TRY(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+    GL_TRY(glBindVertexArray(0));
+}
+
+SdfPrimitive2D::~SdfPrimitive2D() {
+    glDeleteVertexArrays(1, &vertex_array_index);
+    glDeleteBuffers(1, &vertexBuffer);
+}
+
+bool SdfPrimitive2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    if ((fill_ && !BatchRenderer2D::accepts(fillMaterial)) ||
+        (drawEdges_ && !BatchRenderer2D::accepts(strokeMaterial))) return false;
+
+    batch.addInstance(shape_, parameter_, strokeWidth_, model,
+                      fill_ ? fillMaterial.get() : nullptr,
+                      drawEdges_ ? strokeMaterial.get() : nullptr);
+    return true;
+}
+
+void SdfPrimitive2D::tessellate() {
+    const int segments = 64;
+
+    // Outer contour in the unit square (counter-clockwise)
+    std::vector<glm::vec2> outer;
+    if (shape_ == Shape::RoundedRectangle) {
+        float radius = std::clamp(parameter_, 0.0f, 0.5f);
+        const glm::vec2 centers[] = {
+                { 0.5f - radius,  0.5f - radius},
+                {-0.5f + radius,  0.5f - radius},
+                {-0.5f + radius, -0.5f + radius},
+                { 0.5f - radius, -0.5f + radius}
+        };
+        for (int corner = 0; corner < 4; corner++) {
+            for (int i = 0; i <= segments / 4; i++) {
+                float theta = float(M_PI) * 0.5f * (float(corner) + float(i) / float(segments / 4));
+                outer.push_back(centers[corner] + radius * glm::vec2(cosf(theta), sinf(theta)));
+            }
+        }
+    } else {
+        for (int i = 0; i < segments; i++) {
+            float theta = 2.0f * float(M_PI) * float(i) / float(segments);
+            outer.emplace_back(0.5f * cosf(theta), 0.5f * sinf(theta));
+        }
+    }
+
+    std::vector<glm::vec2> inner;
+    if (shape_ == Shape::Ring) {
+        float innerRadius = std::clamp(parameter_, 0.0f, 1.0f);
+        for (const glm::vec2& point: outer) inner.push_back(point * innerRadius);
+    }
+
+    std::vector<glm::vec2> vertices;
+    size_t count = outer.size();
+    for (size_t i = 0; i < count; i++) {
+        size_t next = (i + 1) % count;
+        if (shape_ == Shape::Ring) {
+            vertices.insert(vertices.end(), {inner[i], outer[i], outer[next]});
+            vertices.insert(vertices.end(), {inner[i], outer[next], inner[next]});
+        } else {
+            vertices.insert(vertices.end(), {glm::vec2(0.0f), outer[i], outer[next]});
+        }
+    }
+    fillVertexCount = (int) vertices.size();
+
+    for (size_t i = 0; i < count; i++) {
+        vertices.insert(vertices.end(), {outer[i], outer[(i + 1) % count]});
+    }
+    for (size_t i = 0; i < inner.size(); i++) {
+        vertices.insert(vertices.end(), {inner[i], inner[(i + 1) % inner.size()]});
+    }
+    lineVertexCount = (int) vertices.size() - fillVertexCount;
+
+    GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
+    GL_TRY(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW));
+    geometryDirty_ = false;
+}
+
+void SdfPrimitive2D::draw() {
+    if (geometryDirty_) tessellate();
 
     glBindVertexArray(vertex_array_index);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
 
-    // Layout
-    {
-        GL_TRY(glEnableVertexAttribArray(
-                0));                                                    // Enable vertex attribute array 0.
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr  // Offset of the first component.
-        ));
+    if (fill_) {
+        MaterialObject2D::fillMaterial->bind();
+        glDrawArrays(GL_TRIANGLES, 0, fillVertexCount);
     }
 
-//    Shaders::flatShader->bind();
-    glDrawArrays(GL_LINES, 0, 4);
+    if (drawEdges_) {
+        MaterialObject2D::strokeMaterial->bind();
+        glDrawArrays(GL_LINES, fillVertexCount, lineVertexCount);
+    }
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+//endregion
+
+
+//region --------------------------------- Line2D -----------------------------
+
+void Line2D::draw() {
+    // Both materials are constructed from the same one, use whichever survived the move
+    (fillMaterial ? fillMaterial : strokeMaterial)->bind();
+    GeometryRegistry2D::bindSegments();
+    glDrawArrays(GL_LINES, GLint(segment_ * 2), 2);
+    glBindVertexArray(0);
 }
 
 Line2D::Line2D(std::shared_ptr<Material> material) : MaterialObject2D(std::move(material), std::move(material)) {
-    GL_TRY(glGenVertexArrays(1, &vertex_array_index));      // Generate a vertex array object.
-    GL_TRY(glBindVertexArray(vertex_array_index));          // Bind the vertex array object.
+    segment_ = GeometryRegistry2D::allocateSegment({0.0f, 0.0f}, {x2, y2});
+}
 
-    float vertices[] = {
-            0, 0,
-            x2, y2
-    };
+bool Line2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    // Both materials are constructed from the same one, use whichever survived the move
+    const std::shared_ptr<Material>& material = fillMaterial ? fillMaterial : strokeMaterial;
+    if (!BatchRenderer2D::accepts(material)) return false;
 
-    // Vertex Buffer
-    {
-        // Generate a buffer object for vertex data.
-        GL_TRY(glGenBuffers(1, &vertexBuffer));
-        // Bind the buffer as an array buffer.
-        GL_TRY(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
-        // Load vertex data into the buffer
-        GL_TRY(glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(float), vertices, GL_STATIC_DRAW));
-    }
+    batch.addLine({0.0f, 0.0f}, {x2, y2}, model, *material);
+    return true;
+}
 
-    // Layout
-    {
-        GL_TRY(glEnableVertexAttribArray(0));                    // Enable vertex attribute array 0.
-        GL_TRY(glVertexAttribPointer(
-                0,              // Attribute index.
-                2,              // Number of components per vertex attribute.
-                GL_FLOAT,       // Data type of each component.
-                GL_FALSE,       // Normalization.
-                0,              // Byte offset between consecutive attributes.
-                nullptr         // Offset of the first component.
-        ));
-    }
+glm::vec4 Line2D::getLocalBounds() const {
+    return {std::min(0.0f, x2), std::min(0.0f, y2), std::max(0.0f, x2), std::max(0.0f, y2)};
 }
 
 Line2D::~Line2D() {
-    glDeleteVertexArrays(1, &vertex_array_index);    // Delete the vertex array object.
-    glDeleteBuffers(1, &vertexBuffer);              // Delete the vertex buffer object.
+    GeometryRegistry2D::releaseSegment(segment_);
 }
 
 //endregion
@@ -1071,7 +1499,33 @@ void KiwiComponent2D::draw() {
     }
 }
 
+bool KiwiComponent2D::appendToBatch(BatchRenderer2D& batch, const glm::mat3& model) {
+    for (const std::shared_ptr<Object2D>& obj: drawList) {
+        batch.submit(*obj, obj->transform * model);
+    }
+    return true;
+}
+
+void KiwiComponent2D::appendToQueue(RenderQueue2D& queue, const glm::mat3& model) {
+    for (const std::shared_ptr<Object2D>& obj: drawList) {
+        obj->appendToQueue(queue, obj->transform * model);
+    }
+}
+
+glm::vec4 KiwiComponent2D::getLocalBounds() const {
+    return {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+            std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+}
+
+void KiwiComponent2D::invalidateBounds() {
+    if (boundsDirty) return;    // already queued
+    boundsDirty = true;
+    if (owner) owner->markComponentDirty(ownerIndex);
+}
+
 glm::vec4 KiwiComponent2D::getBoundingBox() {
+    if (!boundsDirty && cachedBoundsTransform == transform) return cachedBounds;
+
     float minX = 100.0f;
     float minY = 100.0f;
     float maxX = -100.0f;
@@ -1096,7 +1550,10 @@ glm::vec4 KiwiComponent2D::getBoundingBox() {
 
     }
 
-    return {minX, minY, maxX, maxY};
+    cachedBounds = {minX, minY, maxX, maxY};
+    cachedBoundsTransform = transform;
+    boundsDirty = false;
+    return cachedBounds;
 }
 
 void KiwiComponent2D::onMouseEvent(MouseEvent mouseEvent) {
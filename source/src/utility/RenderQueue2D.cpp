@@ -0,0 +1,188 @@
+/**
+ * @file RenderQueue2D.cpp
+ * @brief Implementation of the 2D render queue.
+ */
+
+#include "utility/RenderQueue2D.h"
+
+#include <algorithm>
+#include <typeinfo>
+
+// Objects per depth range; exceeding it flushes and clears the depth buffer
+static constexpr size_t MAX_QUEUE_OBJECTS = 1 << 20;
+static constexpr float QUEUE_DEPTH_STEP = 2.0f / float(MAX_QUEUE_OBJECTS + 1);
+
+// Below this many entries a comparison sort is cheaper than the histogram passes
+static constexpr size_t RADIX_SORT_THRESHOLD = 256;
+
+// Key fields: shift and width
+static constexpr int GROUP_SHIFT = 48;
+static constexpr int TRANSLUCENT_SHIFT = 47;
+static constexpr int SHADER_SHIFT = 35;
+static constexpr int MATERIAL_SHIFT = 19;
+static constexpr int GEOMETRY_SHIFT = 11;
+static constexpr uint64_t SHADER_MASK = (1 << 12) - 1;
+static constexpr uint64_t DEPTH_MASK = (1 << 11) - 1;
+
+// Id of a state, assigned in order of appearance; ids past the key width share the last one
+template<class Id>
+static Id lookupId(std::unordered_map<const void*, Id>& ids, const void* state, size_t limit) {
+    auto [it, inserted] = ids.try_emplace(state, Id(std::min(ids.size(), limit)));
+    return it->second;
+}
+
+// LSD radix sort on 8-bit digits; passes where all keys share the digit are skipped
+template<class Entry>
+static void radixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch) {
+    scratch.resize(entries.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256] = {};
+        for (const Entry& entry: entries) histogram[(entry.key >> shift) & 0xFF]++;
+        if (histogram[(entries[0].key >> shift) & 0xFF] == entries.size()) continue;
+
+        size_t offset = 0;
+        for (size_t& count: histogram) {
+            size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (const Entry& entry: entries) scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        entries.swap(scratch);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//      RenderQueue2D
+//----------------------------------------------------------------------------------------------------------------------
+
+void RenderQueue2D::begin() {
+    items_.clear();
+    group_ = 0;
+    stats_ = RenderQueueStats2D{};
+}
+
+void RenderQueue2D::add(Object2D& object, const glm::mat3& model) {
+    if (items_.size() >= MAX_QUEUE_OBJECTS || group_ >= UINT16_MAX - 1) {
+        flush();
+        items_.clear();
+        group_ = 0;
+    }
+    stats_.objects++;
+
+    Item item{};
+    item.object = &object;
+    item.model = model;
+    item.sequence = static_cast<uint32_t>(items_.size());
+
+    // Only objects drawn with the flat shader can write the per-object depth
+    const Material* material = object.getSortMaterial();
+    if (!material || material->getShader() != Shaders::flatShader) {
+        // Draw on its own, between everything before and everything after
+        if (!items_.empty() && items_.back().group == group_) group_++;
+        item.group = group_++;
+        items_.push_back(item);
+        return;
+    }
+
+    item.material = material;
+    item.group = group_;
+    item.translucent = object.isTranslucent();
+    item.shaderId = lookupId<uint16_t>(shaderIds_, material->getShader().get(), SHADER_MASK);
+    item.materialId = lookupId<uint16_t>(materialIds_, material, UINT16_MAX);
+    item.geometryId = lookupId<uint8_t>(geometryIds_, &typeid(object), UINT8_MAX);
+    items_.push_back(item);
+}
+
+void RenderQueue2D::end() {
+    flush();
+    items_.clear();
+    shaderIds_.clear();
+    materialIds_.clear();
+    geometryIds_.clear();
+}
+
+uint64_t RenderQueue2D::buildKey(const Item& item, size_t count) const {
+    uint64_t key = uint64_t(item.group) << GROUP_SHIFT;
+    if (!item.material) return key;
+
+    // Translucent objects keep the submission order
+    if (item.translucent) return key | (uint64_t(1) << TRANSLUCENT_SHIFT) | item.sequence;
+
+    // Opaque objects by state, then front to back so hidden fragments fail the depth test
+    uint64_t front = DEPTH_MASK - uint64_t(item.sequence) * (DEPTH_MASK + 1) / count;
+    return key | (uint64_t(item.shaderId) << SHADER_SHIFT) | (uint64_t(item.materialId) << MATERIAL_SHIFT)
+           | (uint64_t(item.geometryId) << GEOMETRY_SHIFT) | front;
+}
+
+void RenderQueue2D::flush() {
+    if (items_.empty()) return;
+    stats_.groups += size_t(items_.back().group) + 1;
+
+    entries_.resize(items_.size());
+    for (size_t i = 0; i < items_.size(); i++) {
+        entries_[i] = {buildKey(items_[i], items_.size()), static_cast<uint32_t>(i)};
+    }
+    if (entries_.size() < RADIX_SORT_THRESHOLD) {
+        std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+            return a.key < b.key;
+        });
+    } else {
+        radixSort(entries_, scratch_);
+    }
+
+    // Depth only orders the objects of this queue
+    GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+    GLint previousDepthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &previousDepthFunc);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glDepthFunc(GL_LEQUAL);
+
+    bool depthTest = depthTestEnabled;
+    bool depthWrite = true;
+    const Material* lastMaterial = nullptr;
+    const Shader* lastShader = nullptr;
+    for (const Entry& entry: entries_) {
+        const Item& item = items_[entry.item];
+
+        // Unsorted objects: plain painter's order
+        bool wantDepthTest = item.material != nullptr;
+        if (wantDepthTest != depthTest) {
+            if (wantDepthTest) glEnable(GL_DEPTH_TEST);
+            else glDisable(GL_DEPTH_TEST);
+            depthTest = wantDepthTest;
+        }
+        bool wantDepthWrite = !item.translucent;
+        if (wantDepthWrite != depthWrite) {
+            glDepthMask(wantDepthWrite ? GL_TRUE : GL_FALSE);
+            depthWrite = wantDepthWrite;
+        }
+
+        if (item.material != lastMaterial) {
+            stats_.materialChanges++;
+            lastMaterial = item.material;
+            const Shader* shader = item.material ? item.material->getShader().get() : nullptr;
+            if (shader != lastShader) {
+                stats_.shaderChanges++;
+                lastShader = shader;
+            }
+        }
+
+        drawItem(item, item.material ? 1.0f - float(item.sequence + 1) * QUEUE_DEPTH_STEP : 0.0f);
+    }
+
+    if (!depthWrite) glDepthMask(GL_TRUE);
+    if (depthTest != bool(depthTestEnabled)) {
+        if (depthTestEnabled) glEnable(GL_DEPTH_TEST);
+        else glDisable(GL_DEPTH_TEST);
+    }
+    glDepthFunc(previousDepthFunc);
+
+    // Other users of the flat shader draw without depth
+    Shaders::flatShader->setUniform1f("depth", 0.0f);
+}
+
+void RenderQueue2D::drawItem(const Item& item, float depth) {
+    Shaders::flatShader->setUniform1f("depth", depth);
+    Shaders::flatShader->setUniform3x3f("transform", item.model);
+    item.object->draw();
+}
@@ -0,0 +1,207 @@
+/**
+ * @file RenderThread.cpp
+ * @brief Implementation of the render thread.
+ */
+
+#include "utility/RenderThread.h"
+#include "utility/Layer2D.h"
+#include "utility/Logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+RenderThread::RenderThread() = default;
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+//------------------------------------------------------------------------------
+// UI thread
+//------------------------------------------------------------------------------
+bool RenderThread::start(GLFWwindow* sharedWith) {
+    if (isRunning()) return true;
+
+    // Hidden window: only its context is used, it never presents
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context_ = glfwCreateWindow(1, 1, "Kiwi Render Thread", nullptr, sharedWith);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context_) {
+        Logger::Error("RenderThread", "Could not create a shared OpenGL context", {"graphics"});
+        return false;
+    }
+
+    stopRequested_.store(false, std::memory_order_relaxed);
+    gpuFrameTime_.store(0.0, std::memory_order_relaxed);
+    renderedFrames_.store(0, std::memory_order_relaxed);
+    thread_ = std::thread(&RenderThread::run, this);
+    Logger::Info("RenderThread", "Started", {"graphics"});
+    return true;
+}
+
+void RenderThread::stop() {
+    if (!isRunning()) return;
+
+    stopRequested_.store(true, std::memory_order_release);
+    submittedJobs_.fetch_add(1, std::memory_order_release);
+    submittedJobs_.notify_one();
+    thread_.join();
+
+    glfwDestroyWindow(context_);
+    context_ = nullptr;
+    Logger::Info("RenderThread", "Stopped", {"graphics"});
+}
+
+void RenderThread::submit(RenderJob job) {
+    if (!isRunning() || job.width <= 0 || job.height <= 0) return;
+
+    // Overwrites the previous job if the render thread has not taken it yet
+    jobs_.back() = std::move(job);
+    jobs_.publish();
+    submittedJobs_.fetch_add(1, std::memory_order_release);
+    submittedJobs_.notify_one();
+}
+
+bool RenderThread::acquireFrame() {
+    if (!isRunning()) return false;
+
+    if (frames_.update()) {
+        // Server-side wait: the UI thread goes on, only its draws sampling the frame wait
+        FrameSlot& slot = frames_.front();
+        if (slot.rendered) glWaitSync(slot.rendered, 0, GL_TIMEOUT_IGNORED);
+    }
+    return frames_.front().frame != nullptr;
+}
+
+void RenderThread::waitForFrame() {
+    if (!isRunning()) return;
+
+    FrameSlot& slot = frames_.front();
+    if (slot.rendered) glWaitSync(slot.rendered, 0, GL_TIMEOUT_IGNORED);
+}
+
+void RenderThread::frameDisplayed() {
+    if (!isRunning()) return;
+
+    FrameSlot& slot = frames_.front();
+    if (!slot.frame) return;
+
+    // One fence per context: a later draw of the same context supersedes the earlier one
+    GLFWwindow* context = glfwGetCurrentContext();
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    auto displayed = std::find_if(slot.displayed.begin(), slot.displayed.end(),
+                                  [context](const std::pair<GLFWwindow*, GLsync>& entry) {
+                                      return entry.first == context;
+                                  });
+    if (displayed != slot.displayed.end()) {
+        glDeleteSync(displayed->second);
+        displayed->second = fence;
+    } else {
+        slot.displayed.emplace_back(context, fence);
+    }
+    glFlush();  // the render context waits on it
+}
+
+unsigned int RenderThread::getFrameTexture() {
+    FrameSlot& slot = frames_.front();
+    return isRunning() && slot.frame ? slot.frame->getTexture() : 0;
+}
+
+glm::vec2 RenderThread::getFrameUVScale() {
+    FrameSlot& slot = frames_.front();
+    return slot.frame ? slot.frame->getUVScale() : glm::vec2(1.0f);
+}
+
+//------------------------------------------------------------------------------
+// Render thread
+//------------------------------------------------------------------------------
+void RenderThread::run() {
+    glfwMakeContextCurrent(context_);
+    glGenVertexArrays(1, &vertexArray_);
+    glGenQueries(2, gpuTimerQueries_);
+
+    uint64_t seen = 0;
+    while (true) {
+        submittedJobs_.wait(seen, std::memory_order_acquire);
+        seen = submittedJobs_.load(std::memory_order_acquire);
+        bool stopping = stopRequested_.load(std::memory_order_acquire);
+
+        // Only the newest job is rendered, also the last one before stopping
+        if (jobs_.update()) {
+            RenderJob& job = jobs_.front();
+            if (job.draw) renderJob(job);
+            job = {};   // release the snapshot on this thread
+        }
+        if (stopping) break;
+    }
+
+    // Frames and pending jobs hold objects of this context
+    for (RenderJob& job: jobs_.slots()) job = {};
+    for (FrameSlot& slot: frames_.slots()) {
+        if (slot.rendered) glDeleteSync(slot.rendered);
+        for (const auto& [context, fence]: slot.displayed) glDeleteSync(fence);
+        slot = {};
+    }
+    glDeleteQueries(2, gpuTimerQueries_);
+    glDeleteVertexArrays(1, &vertexArray_);
+    gpuTimerQueries_[0] = gpuTimerQueries_[1] = 0;
+    queryPending_[0] = queryPending_[1] = false;
+    vertexArray_ = 0;
+
+    glFinish();
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::renderJob(RenderJob& job) {
+    FrameSlot& slot = frames_.back();
+
+    // The UI contexts may still be sampling this frame from an earlier display
+    for (const auto& [context, fence]: slot.displayed) {
+        glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+    }
+    slot.displayed.clear();
+    if (slot.rendered) {
+        glDeleteSync(slot.rendered);
+        slot.rendered = nullptr;
+    }
+
+    if (!slot.frame) slot.frame = std::make_unique<KiwiFrame>(false, job.depth);
+    slot.frame->setDepthBuffer(job.depth);
+    if (slot.frame->size() != glm::vec2(job.width, job.height)) {
+        slot.frame->resize(job.width, job.height);
+    }
+
+    measureGpuTime();
+    glBeginQuery(GL_TIME_ELAPSED, gpuTimerQueries_[currentQuery_]);
+    slot.frame->bind();
+    glBindVertexArray(vertexArray_);
+    job.draw();
+    glBindVertexArray(0);
+    KiwiFrame::unbind();
+    glEndQuery(GL_TIME_ELAPSED);
+    queryPending_[currentQuery_] = true;
+    currentQuery_ = 1 - currentQuery_;
+
+    slot.rendered = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();  // the UI context waits on the fence
+    frames_.publish();
+    renderedFrames_.fetch_add(1, std::memory_order_relaxed);
+    glfwPostEmptyEvent();   // wakes an idle UI waiting for events
+}
+
+void RenderThread::measureGpuTime() {
+    // Read the query of the previous frame without blocking
+    int previousQuery = 1 - currentQuery_;
+    if (!queryPending_[previousQuery]) return;
+
+    GLint available = 0;
+    glGetQueryObjectiv(gpuTimerQueries_[previousQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint64 timeElapsed = 0;
+    glGetQueryObjectui64v(gpuTimerQueries_[previousQuery], GL_QUERY_RESULT, &timeElapsed);
+    gpuFrameTime_.store(static_cast<double>(timeElapsed) / 1000000.0, std::memory_order_relaxed);
+    queryPending_[previousQuery] = false;
+}
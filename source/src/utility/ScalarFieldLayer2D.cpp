@@ -0,0 +1,263 @@
+/**
+ * @file ScalarFieldLayer2D.cpp
+ * @brief Implementation of the colormapped scalar field layer.
+ */
+
+#include "utility/ScalarFieldLayer2D.h"
+#include "utility/ColormapTextures.h"
+#include "utility/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+// Entries of the colormap lookup textures, the first and last texel centers are
+// the ends of the colormap
+static constexpr float COLORMAP_ENTRIES = 512.0f;
+
+// The field is a quad spanning the extent, generated from gl_VertexID (triangle strip)
+static const std::string fieldVertexShader = R"(
+    #version 330 core
+    uniform mat3 camera;
+    uniform vec4 extent;        // minX, minY, maxX, maxY
+
+    out vec2 uv;
+
+    void main() {
+        vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+        uv = corner;
+        vec3 position = camera * vec3(mix(extent.xy, extent.zw, corner), 1.0);
+        gl_Position = vec4(position.xy, 0.0, 1.0);
+    }
+)";
+
+static const std::string fieldFragmentShader = R"(
+    #version 330 core
+    uniform sampler2D field;
+    uniform sampler1D colormap;
+    uniform vec2 range;         // normalization range, log10 of the range in log scale
+    uniform int logScale;
+    uniform float lutScale;     // maps [0, 1] to the texel centers of the lookup texture
+    uniform float lutOffset;
+
+    in vec2 uv;
+    out vec4 FragColor;
+
+    void main() {
+        float value = texture(field, uv).r;
+
+        // Missing data (NaN) and values without a logarithm stay transparent
+        if (isnan(value) || (logScale != 0 && value <= 0.0)) discard;
+        if (logScale != 0) value = log(value) * 0.43429448;     // log10
+
+        float t = clamp((value - range.x) / max(range.y - range.x, 1e-30), 0.0, 1.0);
+        FragColor = vec4(texture(colormap, t * lutScale + lutOffset).rgb, 1.0);
+    }
+)";
+
+//----------------------------------------------------------------------------------------------------------------------
+//      ScalarFieldLayer2D
+//----------------------------------------------------------------------------------------------------------------------
+
+ScalarFieldLayer2D::ScalarFieldLayer2D() {
+    shader_ = std::make_shared<Shader>(fieldVertexShader, fieldFragmentShader);
+    glGenVertexArrays(1, &vertex_array_index);
+}
+
+ScalarFieldLayer2D::~ScalarFieldLayer2D() {
+    if (fieldTexture) glDeleteTextures(1, &fieldTexture);
+    glDeleteVertexArrays(1, &vertex_array_index);
+}
+
+void ScalarFieldLayer2D::render(float windowWidth, float windowHeight, double time, double deltaTime) {
+    if (fieldTexture) {
+        Shader::invalidateBinding();
+
+        glm::vec2 range = range_;
+        if (logScale_) {
+            // A non-positive range has no logarithm: fall back to the positive part of the data
+            float low = range.x > 0.0f ? range.x : dataMinPositive_;
+            float high = std::max(range.y, low);
+            range = {std::log10(low), std::log10(high)};
+        }
+
+        shader_->bind();
+        shader_->setUniform3x3f("camera", getCamera().getTransformation());
+        shader_->setUniform4f("extent", extent_.x, extent_.y, extent_.z, extent_.w);
+        shader_->setUniform2f("range", range.x, range.y);
+        shader_->setUniform1i("logScale", logScale_ ? 1 : 0);
+        shader_->setUniform1f("lutScale", (COLORMAP_ENTRIES - 1.0f) / COLORMAP_ENTRIES);
+        shader_->setUniform1f("lutOffset", 0.5f / COLORMAP_ENTRIES);
+        shader_->setUniform1i("field", 0);
+        shader_->setUniform1i("colormap", 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, fieldTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D, ColormapTextures::get(colormap_));
+
+        glBindVertexArray(vertex_array_index);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+
+        glBindTexture(GL_TEXTURE_1D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Grid, objects and plots on top of the field
+    KiwiLayer2D::render(windowWidth, windowHeight, time, deltaTime);
+}
+
+bool ScalarFieldLayer2D::setData(const float* values, int width, int height) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (width <= 0 || height <= 0 || width > maxSize || height > maxSize) {
+        Logger::Error("ScalarFieldLayer2D", "Field size " + std::to_string(width) + "x" + std::to_string(height)
+                      + " is outside the texture limit of " + std::to_string(maxSize), {"texture"});
+        return false;
+    }
+
+    // Finite range of the data, used by fitRange()
+    float low = std::numeric_limits<float>::max();
+    float high = std::numeric_limits<float>::lowest();
+    float lowPositive = std::numeric_limits<float>::max();
+    size_t count = static_cast<size_t>(width) * static_cast<size_t>(height);
+    for (size_t i = 0; i < count; i++) {
+        float value = values[i];
+        if (!std::isfinite(value)) continue;
+        low = std::min(low, value);
+        high = std::max(high, value);
+        if (value > 0.0f) lowPositive = std::min(lowPositive, value);
+    }
+    dataRange_ = low <= high ? glm::vec2(low, high) : glm::vec2(0.0f, 1.0f);
+    dataMinPositive_ = lowPositive <= high ? lowPositive : 1.0f;
+
+    if (!fieldTexture) {
+        glGenTextures(1, &fieldTexture);
+        glBindTexture(GL_TEXTURE_2D, fieldTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        setInterpolation(linear_);
+    }
+
+    // Same size: update in place instead of reallocating the storage
+    glBindTexture(GL_TEXTURE_2D, fieldTexture);
+    if (size_.x == width && size_.y == height) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_FLOAT, values);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, values);
+        size_ = {width, height};
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    invalidate();
+    return true;
+}
+
+bool ScalarFieldLayer2D::loadRaw(const std::string& path, int width, int height) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        Logger::Error("ScalarFieldLayer2D", "Cannot open " + path, {"file"});
+        return false;
+    }
+
+    std::vector<float> values(static_cast<size_t>(std::max(width, 0)) * static_cast<size_t>(std::max(height, 0)));
+    file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(float)));
+    if (file.gcount() != static_cast<std::streamsize>(values.size() * sizeof(float))) {
+        Logger::Error("ScalarFieldLayer2D", path + " is smaller than " + std::to_string(width) + "x"
+                      + std::to_string(height) + " float32 values", {"file"});
+        return false;
+    }
+    return setData(values.data(), width, height);
+}
+
+bool ScalarFieldLayer2D::loadNpy(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        Logger::Error("ScalarFieldLayer2D", "Cannot open " + path, {"file"});
+        return false;
+    }
+
+    // Magic string, format version, then the length of the header dictionary
+    char magic[8] = {};
+    file.read(magic, 8);
+    if (!file || std::memcmp(magic, "\x93NUMPY", 6) != 0) {
+        Logger::Error("ScalarFieldLayer2D", path + " is not a .npy file", {"file"});
+        return false;
+    }
+    unsigned char lengthBytes[4] = {};
+    size_t headerLength;
+    if (magic[6] == 1) {
+        file.read(reinterpret_cast<char*>(lengthBytes), 2);
+        headerLength = lengthBytes[0] | (lengthBytes[1] << 8);
+    } else {
+        file.read(reinterpret_cast<char*>(lengthBytes), 4);
+        headerLength = lengthBytes[0] | (lengthBytes[1] << 8) | (lengthBytes[2] << 16) | (size_t(lengthBytes[3]) << 24);
+    }
+    std::string header(headerLength, '\0');
+    file.read(header.data(), static_cast<std::streamsize>(headerLength));
+
+    // e.g. {'descr': '<f4', 'fortran_order': False, 'shape': (480, 640), }
+    bool isFloat32 = header.find("'<f4'") != std::string::npos;
+    bool isFloat64 = header.find("'<f8'") != std::string::npos;
+    if (!isFloat32 && !isFloat64) {
+        Logger::Error("ScalarFieldLayer2D", path + ": only little-endian float32/float64 arrays are supported", {"file"});
+        return false;
+    }
+    if (header.find("'fortran_order': False") == std::string::npos) {
+        Logger::Error("ScalarFieldLayer2D", path + ": only C-ordered arrays are supported", {"file"});
+        return false;
+    }
+    size_t shapeStart = header.find('(', header.find("'shape'"));
+    size_t shapeEnd = header.find(')', shapeStart);
+    int rows = 0, columns = 0;
+    if (shapeStart == std::string::npos || shapeEnd == std::string::npos
+        || std::sscanf(header.substr(shapeStart, shapeEnd - shapeStart + 1).c_str(), "(%d, %d)", &rows, &columns) != 2) {
+        Logger::Error("ScalarFieldLayer2D", path + ": only 2D arrays are supported", {"file"});
+        return false;
+    }
+
+    size_t count = static_cast<size_t>(std::max(rows, 0)) * static_cast<size_t>(std::max(columns, 0));
+    std::vector<float> values(count);
+    if (isFloat32) {
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(float)));
+    } else {
+        std::vector<double> doubles(count);
+        file.read(reinterpret_cast<char*>(doubles.data()), static_cast<std::streamsize>(count * sizeof(double)));
+        for (size_t i = 0; i < count; i++) values[i] = static_cast<float>(doubles[i]);
+    }
+    if (!file) {
+        Logger::Error("ScalarFieldLayer2D", path + " is truncated", {"file"});
+        return false;
+    }
+
+    // Row 0 of the array is drawn at the bottom of the extent
+    return setData(values.data(), columns, rows);
+}
+
+void ScalarFieldLayer2D::setRange(float minValue, float maxValue) {
+    range_ = {minValue, maxValue};
+    invalidate();
+}
+
+void ScalarFieldLayer2D::fitRange() {
+    range_ = dataRange_;
+    if (logScale_ && range_.x <= 0.0f) range_.x = dataMinPositive_;
+    invalidate();
+}
+
+void ScalarFieldLayer2D::setInterpolation(bool linear) {
+    linear_ = linear;
+    invalidate();
+    if (!fieldTexture) return;
+
+    // R32F is filterable on every GL 3.3+ desktop driver
+    GLint filter = linear ? GL_LINEAR : GL_NEAREST;
+    glBindTexture(GL_TEXTURE_2D, fieldTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,156 @@
+/**
+ * @file SceneGraph2D.cpp
+ * @brief Implementation of the retained 2D scene graph.
+ */
+
+#include "utility/SceneGraph2D.h"
+
+#include <algorithm>
+#include <limits>
+
+static const glm::vec4 EMPTY_BOUNDS = {
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()
+};
+
+static glm::vec4 unite(const glm::vec4& a, const glm::vec4& b) {
+    return {std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w)};
+}
+
+static bool intersects(const glm::vec4& a, const glm::vec4& b) {
+    return a.x <= b.z && a.z >= b.x && a.y <= b.w && a.w >= b.y;
+}
+
+// World AABB of a local box under an affine transform
+static glm::vec4 transformBounds(const glm::vec4& local, const glm::mat3& model) {
+    if (local.x > local.z || local.y > local.w) return EMPTY_BOUNDS;
+
+    // Unbounded objects are never culled
+    if (local.x == std::numeric_limits<float>::lowest()) return -EMPTY_BOUNDS;
+
+    glm::vec4 bounds = EMPTY_BOUNDS;
+    const glm::vec2 corners[] = {{local.x, local.y}, {local.z, local.y}, {local.z, local.w}, {local.x, local.w}};
+    for (const glm::vec2& corner: corners) {
+        glm::vec2 p = glm::vec2(model * glm::vec3(corner, 1.0f));
+        bounds = unite(bounds, {p.x, p.y, p.x, p.y});
+    }
+    return bounds;
+}
+
+//------------------------------------------------------------------------------
+// Hierarchy
+//------------------------------------------------------------------------------
+std::shared_ptr<SceneNode2D> SceneNode2D::createChild() {
+    auto child = std::make_shared<SceneNode2D>();
+    addChild(child);
+    return child;
+}
+
+void SceneNode2D::addChild(const std::shared_ptr<SceneNode2D>& child) {
+    if (child->parent_) child->parent_->removeChild(child);
+    child->parent_ = this;
+    children_.push_back(child);
+    child->invalidate();
+}
+
+void SceneNode2D::removeChild(const std::shared_ptr<SceneNode2D>& child) {
+    auto it = std::find(children_.begin(), children_.end(), child);
+    if (it == children_.end()) return;
+
+    (*it)->parent_ = nullptr;
+    children_.erase(it);
+
+    // Subtree bounds shrink
+    childDirty_ = true;
+    flagAncestors();
+}
+
+void SceneNode2D::attach(const std::shared_ptr<Object2D>& object) {
+    objects_.push_back(object);
+    invalidate();
+}
+
+void SceneNode2D::detach(const std::shared_ptr<Object2D>& object) {
+    auto it = std::find(objects_.begin(), objects_.end(), object);
+    if (it == objects_.end()) return;
+    objects_.erase(it);
+    invalidate();
+}
+
+void SceneNode2D::setTransform(const glm::mat3& local) {
+    local_ = local;
+    invalidate();
+}
+
+//------------------------------------------------------------------------------
+// Dirty propagation
+//------------------------------------------------------------------------------
+void SceneNode2D::invalidate() {
+    dirty_ = true;
+    flagAncestors();
+}
+
+void SceneNode2D::flagAncestors() {
+    // Stops at the first ancestor that is already flagged, the rest of the path is too
+    for (SceneNode2D* node = parent_; node && !node->childDirty_; node = node->parent_) {
+        node->childDirty_ = true;
+    }
+}
+
+void SceneNode2D::update() {
+    update(parent_ ? parent_->world_ : glm::mat3(1.0f), false);
+}
+
+void SceneNode2D::update(const glm::mat3& parentWorld, bool parentChanged) {
+    bool changed = dirty_ || parentChanged;
+    if (!changed && !childDirty_) return;
+
+    if (changed) {
+        world_ = parentWorld * local_;
+
+        objectBounds_.resize(objects_.size());
+        ownBounds_ = EMPTY_BOUNDS;
+        for (size_t i = 0; i < objects_.size(); i++) {
+            objectBounds_[i] = transformBounds(objects_[i]->getLocalBounds(), world_ * objects_[i]->transform);
+            ownBounds_ = unite(ownBounds_, objectBounds_[i]);
+        }
+    }
+
+    subtreeBounds_ = ownBounds_;
+    subtreeObjects_ = objects_.size();
+    for (const std::shared_ptr<SceneNode2D>& child: children_) {
+        child->update(world_, changed);
+        subtreeBounds_ = unite(subtreeBounds_, child->subtreeBounds_);
+        subtreeObjects_ += child->subtreeObjects_;
+    }
+
+    dirty_ = false;
+    childDirty_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Traversal
+//------------------------------------------------------------------------------
+void SceneNode2D::traverse(const glm::vec4& view, const std::function<void(Object2D&, const glm::mat3&)>& visitor,
+                           SceneStats2D& stats) const {
+    if (!visible_) return;
+
+    // Whole subtree outside the view
+    if (!intersects(subtreeBounds_, view)) {
+        stats.culled += subtreeObjects_;
+        return;
+    }
+
+    for (size_t i = 0; i < objects_.size(); i++) {
+        if (!intersects(objectBounds_[i], view)) {
+            stats.culled++;
+            continue;
+        }
+        stats.drawn++;
+        visitor(*objects_[i], world_ * objects_[i]->transform);
+    }
+
+    for (const std::shared_ptr<SceneNode2D>& child: children_) {
+        child->traverse(view, visitor, stats);
+    }
+}
@@ -0,0 +1,348 @@
+/**
+ * @file ShaderComparison.cpp
+ * @brief Implementation of the A/B shader comparison.
+ */
+
+#include "utility/ShaderComparison.h"
+#include "utility/ShaderPreprocessor.h"
+#include "utility/shader.h"
+#include "utility/Logger.h"
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <filesystem>
+
+// Weight of the newest GPU time in the smoothed timings
+static constexpr double GPU_TIME_SMOOTHING = 0.1;
+
+// Difference view: fullscreen triangle from gl_VertexID, |A - X| scaled by a gain
+static const std::string differenceVertexShader = R"(
+    #version 330 core
+    out vec2 uv;
+
+    void main() {
+        vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        uv = corner;
+        gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+static const std::string differenceFragmentShader = R"(
+    #version 330 core
+    uniform sampler2D textureA;
+    uniform sampler2D textureB;
+    uniform vec2 uvScaleA;      // active areas of the textures
+    uniform vec2 uvScaleB;
+    uniform float gain;
+
+    in vec2 uv;
+    out vec4 fragColor;
+
+    void main() {
+        vec3 a = texture(textureA, uv * uvScaleA).rgb;
+        vec3 b = texture(textureB, uv * uvScaleB).rgb;
+        fragColor = vec4(abs(a - b) * gain, 1.0);
+    }
+)";
+
+ShaderComparison::ShaderComparison(std::shared_ptr<ShaderLayer> reference)
+        : reference_(std::move(reference)) {}
+
+ShaderComparison::~ShaderComparison() {
+    if (differenceVertexArray_) glDeleteVertexArrays(1, &differenceVertexArray_);
+}
+
+//------------------------------------------------------------------------------
+// Views
+//------------------------------------------------------------------------------
+bool ShaderComparison::addView(const std::string& fragmentPath) {
+    if (views_.size() >= MAX_VIEWS) {
+        Logger::Warn("ShaderComparison", "All comparison views are in use", {"shader"});
+        return false;
+    }
+    if (fragmentPath.empty() || !std::filesystem::exists(fragmentPath)) {
+        Logger::Error("ShaderComparison", "Shader file not found: " + fragmentPath, {"shader", "file"});
+        return false;
+    }
+
+    View view;
+    view.name = nextViewName();
+    view.layer = std::make_shared<ShaderLayer>();
+    view.layer->setInputSource(reference_);
+    view.layer->setLinkUniforms(linkUniforms_);
+    view.layer->loadShader(fragmentPath);
+    view.frame = std::make_unique<KiwiFrame>(false, false);
+
+    Logger::Info("ShaderComparison", "View " + view.name + ": " + fragmentPath, {"shader"});
+    views_.push_back(std::move(view));
+    return true;
+}
+
+void ShaderComparison::removeView(size_t index) {
+    if (index >= views_.size()) return;
+    views_[index].open = false;
+}
+
+void ShaderComparison::setLinkUniforms(bool link) {
+    linkUniforms_ = link;
+    for (View& view: views_) {
+        view.layer->setLinkUniforms(link);
+    }
+}
+
+std::string ShaderComparison::nextViewName() const {
+    for (char letter = 'B'; ; letter++) {
+        std::string name(1, letter);
+        bool used = std::any_of(views_.begin(), views_.end(), [&name](const View& view) {
+            return view.name == name;
+        });
+        if (!used) return name;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Rendering
+//------------------------------------------------------------------------------
+bool ShaderComparison::needsRender() {
+    bool needed = false;
+    for (View& view: views_) {
+        // Poll every view, needsRender() also finishes compiles and hot reloads
+        needed = (view.open && view.layer->needsRender()) || needed;
+    }
+    return needed;
+}
+
+void ShaderComparison::render(float width, float height, double time, double deltaTime,
+                              unsigned int referenceTexture, glm::vec2 referenceUVScale) {
+    referenceTexture_ = referenceTexture;
+    referenceUVScale_ = referenceUVScale;
+    referenceGpuTime_ += (reference_->getGpuFrameTime() - referenceGpuTime_) * GPU_TIME_SMOOTHING;
+    frameSize_ = {width, height};
+
+    const View* difference = nullptr;
+    for (View& view: views_) {
+        if (!view.open) continue;
+        if (view.frame->size() != frameSize_) {
+            view.frame->resize((int) width, (int) height);
+            view.layer->getCamera().setAspectRatio(width, height);
+        }
+        view.frame->bind();
+        view.layer->render(width, height, time, deltaTime);
+        view.gpuTime += (view.layer->getGpuFrameTime() - view.gpuTime) * GPU_TIME_SMOOTHING;
+        if (view.name == differenceView_) difference = &view;
+    }
+    KiwiFrame::unbind();
+    // ShaderLayer binds its programs with glUseProgram
+    Shader::invalidateBinding();
+
+    if (difference && referenceTexture_) renderDifference(*difference);
+}
+
+void ShaderComparison::renderDifference(const View& view) {
+    if (!differenceShader_) {
+        differenceShader_ = std::make_unique<Shader>(differenceVertexShader, differenceFragmentShader);
+        glGenVertexArrays(1, &differenceVertexArray_);
+        differenceFrame_ = std::make_unique<KiwiFrame>(false, false);
+    }
+    if (differenceFrame_->size() != frameSize_) {
+        differenceFrame_->resize((int) frameSize_.x, (int) frameSize_.y);
+    }
+
+    // Every pixel is written, no clear needed
+    differenceFrame_->bind(false);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+
+    differenceShader_->bind();
+    differenceShader_->setUniform1i("textureA", 0);
+    differenceShader_->setUniform1i("textureB", 1);
+    differenceShader_->setUniform2f("uvScaleA", referenceUVScale_.x, referenceUVScale_.y);
+    glm::vec2 uvScale = view.frame->getUVScale();
+    differenceShader_->setUniform2f("uvScaleB", uvScale.x, uvScale.y);
+    differenceShader_->setUniform1f("gain", differenceGain_);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, referenceTexture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, view.frame->getTexture());
+    glBindVertexArray(differenceVertexArray_);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+
+    if (blend) glEnable(GL_BLEND);
+    KiwiFrame::unbind();
+}
+
+//------------------------------------------------------------------------------
+// UI
+//------------------------------------------------------------------------------
+void ShaderComparison::drawWindows() {
+    // Removed views go before any image of this UI frame refers to their frames
+    views_.erase(std::remove_if(views_.begin(), views_.end(), [](const View& view) {
+        return !view.open;
+    }), views_.end());
+    bool differenceFound = std::any_of(views_.begin(), views_.end(), [this](const View& view) {
+        return view.name == differenceView_;
+    });
+    if (!differenceFound) differenceView_.clear();
+
+    for (View& view: views_) {
+        drawView(view);
+    }
+    drawComparisonWindow();
+}
+
+void ShaderComparison::drawFrame(const KiwiFrame& frame, glm::vec2 frameSize) {
+    ImVec2 available = ImGui::GetContentRegionAvail();
+    if (frameSize.x <= 0.0f || frameSize.y <= 0.0f || available.x <= 0.0f || available.y <= 0.0f) return;
+
+    // Fit into the window, keeping the aspect ratio of the viewport
+    float scale = std::min(available.x / frameSize.x, available.y / frameSize.y);
+    glm::vec2 uvScale = frame.getUVScale();
+    ImGui::Image((ImTextureID) frame.getTextureId(), ImVec2(frameSize.x * scale, frameSize.y * scale),
+                 ImVec2(0, uvScale.y), ImVec2(uvScale.x, 0));
+}
+
+void ShaderComparison::drawView(View& view) {
+    std::string title = "View " + view.name + "###ComparisonView" + view.name;
+    ImGui::SetNextWindowSize(ImVec2(480, 320), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin(title.c_str(), &view.open)) {
+        std::string filename = std::filesystem::path(view.layer->getShaderPath()).filename().string();
+        ImGui::Text("%s  %.2f ms", filename.c_str(), view.gpuTime);
+
+        const std::string& error = view.layer->getLastError();
+        if (!error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Compilation Error:");
+            ImGui::TextWrapped("%s", error.c_str());
+        }
+        drawFrame(*view.frame, frameSize_);
+    }
+    ImGui::End();
+}
+
+void ShaderComparison::drawComparisonWindow() {
+    ImGui::SetNextWindowSize(ImVec2(440, 380), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Comparison")) {
+        ImGui::End();
+        return;
+    }
+
+    // ===== Add Views =====
+    bool full = views_.size() >= MAX_VIEWS;
+    ImGui::BeginDisabled(full);
+    ImGui::InputTextWithHint("##ComparisonPath", "Fragment shader path", pathBuffer_, sizeof(pathBuffer_));
+    ImGui::SameLine();
+    if (ImGui::Button("Add")) {
+        addView(pathBuffer_);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Add Current")) {
+        addView(reference_->getShaderPath());
+    }
+    ImGui::EndDisabled();
+    if (full) {
+        ImGui::TextDisabled("At most %zu views besides A", MAX_VIEWS);
+    }
+
+    bool link = linkUniforms_;
+    if (ImGui::Checkbox("Link Uniforms", &link)) {
+        setLinkUniforms(link);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Copy the parameters of A to uniforms with the same name and type");
+    }
+
+    ImGui::Separator();
+
+    // ===== GPU Timings =====
+    if (ImGui::BeginTable("ComparisonTimings", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("View");
+        ImGui::TableSetupColumn("Shader");
+        ImGui::TableSetupColumn("GPU (ms)");
+        ImGui::TableSetupColumn("vs A");
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("A");
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", std::filesystem::path(reference_->getShaderPath()).filename().string().c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", referenceGpuTime_);
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("-");
+        ImGui::TableNextColumn();
+
+        for (size_t i = 0; i < views_.size(); i++) {
+            View& view = views_[i];
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", view.name.c_str());
+            ImGui::TableNextColumn();
+            std::string filename = std::filesystem::path(view.layer->getShaderPath()).filename().string();
+            if (view.layer->getLastError().empty()) {
+                ImGui::Text("%s", filename.c_str());
+            } else {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", filename.c_str());
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", view.gpuTime);
+            ImGui::TableNextColumn();
+            if (referenceGpuTime_ > 0.0) {
+                ImGui::Text("%+.0f%%", (view.gpuTime / referenceGpuTime_ - 1.0) * 100.0);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::TableNextColumn();
+            if (ImGui::SmallButton("Reload")) {
+                view.layer->forceReload();
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Remove")) {
+                removeView(i);
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+
+    // ===== Difference =====
+    std::string preview = differenceView_.empty() ? "Off" : "A - " + differenceView_;
+    if (ImGui::BeginCombo("Difference", preview.c_str())) {
+        if (ImGui::Selectable("Off", differenceView_.empty())) {
+            differenceView_.clear();
+        }
+        for (const View& view: views_) {
+            std::string label = "A - " + view.name;
+            if (ImGui::Selectable(label.c_str(), view.name == differenceView_)) {
+                differenceView_ = view.name;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (!differenceView_.empty()) {
+        ImGui::SliderFloat("Gain", &differenceGain_, 1.0f, 64.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+        if (differenceFrame_) {
+            drawFrame(*differenceFrame_, frameSize_);
+        }
+    }
+
+    ImGui::Separator();
+
+    // ===== Include Cache =====
+    ShaderPreprocessing::IncludeCacheStats stats = ShaderPreprocessing::ShaderPreprocessor::getIncludeCacheStats();
+    ImGui::Text("Include cache: %zu file(s), %zu hit(s), %zu read(s)", stats.files, stats.hits, stats.reads);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Clear")) {
+        ShaderPreprocessing::ShaderPreprocessor::clearIncludeCache();
+    }
+
+    ImGui::End();
+}
@@ -4,6 +4,7 @@
  */
 
 #include "utility/ShaderLayer.h"
+#include "utility/RenderThread.h"
 #include "utility/ShaderPreprocessor.h"
 #include "utility/common.h"
 #include "utility/Logger.h"
@@ -11,7 +12,30 @@
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <algorithm>
 #include <type_traits>
+#include <format>
+
+#include <nlohmann/json.hpp>
+
+//------------------------------------------------------------------------------
+// Timing helper (steady clock, never jumps with wall-clock adjustments)
+//------------------------------------------------------------------------------
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Texture unit for iDepthPrepass, kept away from units a shader is likely to use
+static constexpr int DEPTH_PREPASS_TEXTURE_UNIT = 7;
+
+// Shared ownership of a program: frames still pending on the render thread keep it alive,
+// the last owner deletes it (programs are shared between the contexts)
+static std::shared_ptr<const unsigned int> shareProgram(unsigned int program) {
+    return {new unsigned int(program), [](const unsigned int* p) {
+        glDeleteProgram(*p);
+        delete p;
+    }};
+}
 
 //------------------------------------------------------------------------------
 // Default vertex shader for fullscreen quad
@@ -38,14 +62,35 @@ ShaderLayer::ShaderLayer() {
     
     // Create GPU timer queries for performance profiling
     glGenQueries(2, gpuTimerQueries_);
+
+    // Let the driver compile on as many threads as it likes (0xFFFFFFFF = implementation max)
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallelCompile_ = true;
+    } else if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallelCompile_ = true;
+    }
     
     Logger::Info("ShaderLayer", "Initialized with GPU profiling", {"graphics", "shader"});
+    Logger::Debug("ShaderLayer", std::string("Parallel shader compile: ") + (parallelCompile_ ? "enabled" : "unavailable"), {"graphics", "shader"});
 }
 
 ShaderLayer::~ShaderLayer() {
-    if (shaderProgram_ != 0) {
-        glDeleteProgram(shaderProgram_);
+    deleteVariant(costVariant_);
+    deleteVariant(prepassVariant_);
+    if (prepassFramebuffer_ != 0) {
+        glDeleteFramebuffers(1, &prepassFramebuffer_);
+    }
+    if (prepassTexture_ != 0) {
+        glDeleteTextures(1, &prepassTexture_);
+    }
+    for (const auto& pending : pendingPrograms_) {
+        glDeleteShader(pending.vertexShader);
+        glDeleteShader(pending.fragmentShader);
+        glDeleteProgram(pending.programId);
     }
+    programOwner_.reset();
     if (quadVAO_ != 0) {
         glDeleteVertexArrays(1, &quadVAO_);
     }
@@ -89,65 +134,121 @@ void ShaderLayer::setupFullscreenQuad() {
 //------------------------------------------------------------------------------
 // Shader compilation with error capture
 //------------------------------------------------------------------------------
-ShaderCompileResult ShaderLayer::tryCompileShader(const std::string& vertexSrc, const std::string& fragmentSrc) {
-    ShaderCompileResult result;
-    
-    // Compile vertex shader
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+PendingProgram ShaderLayer::beginCompile(const std::string& vertexSrc, const std::string& fragmentSrc) {
+    PendingProgram pending;
+
+    // Compile and link without querying any status in between, so a driver with
+    // parallel compile support never has to block on its worker threads here
+    auto compileStart = std::chrono::steady_clock::now();
+    pending.vertexShader = glCreateShader(GL_VERTEX_SHADER);
     const char* vSrc = vertexSrc.c_str();
-    glShaderSource(vertexShader, 1, &vSrc, nullptr);
-    glCompileShader(vertexShader);
+    glShaderSource(pending.vertexShader, 1, &vSrc, nullptr);
+    glCompileShader(pending.vertexShader);
+
+    pending.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    const char* fSrc = fragmentSrc.c_str();
+    glShaderSource(pending.fragmentShader, 1, &fSrc, nullptr);
+    glCompileShader(pending.fragmentShader);
+    pending.compileMs = millisecondsSince(compileStart);
+
+    auto linkStart = std::chrono::steady_clock::now();
+    pending.programId = glCreateProgram();
+    glAttachShader(pending.programId, pending.vertexShader);
+    glAttachShader(pending.programId, pending.fragmentShader);
+    glLinkProgram(pending.programId);
+    pending.linkMs = millisecondsSince(linkStart);
+
+    pending.submitTime = std::chrono::steady_clock::now();
+    return pending;
+}
+
+ShaderCompileResult ShaderLayer::collectProgramResult(const PendingProgram& pending) {
+    ShaderCompileResult result;
+    result.compileMs = pending.compileMs;
+    result.linkMs = pending.linkMs;
 
+    // Status queries block until the driver is done, so they count towards the stage
+    auto compileQueryStart = std::chrono::steady_clock::now();
     int success;
     char infoLog[1024];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(pending.vertexShader, GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(vertexShader, 1024, nullptr, infoLog);
+        glGetShaderInfoLog(pending.vertexShader, 1024, nullptr, infoLog);
         result.errorLog = "VERTEX SHADER ERROR:\n" + std::string(infoLog);
-        glDeleteShader(vertexShader);
-        return result;
     }
 
-    // Compile fragment shader
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fSrc = fragmentSrc.c_str();
-    glShaderSource(fragmentShader, 1, &fSrc, nullptr);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 1024, nullptr, infoLog);
-        result.errorLog = "FRAGMENT SHADER ERROR:\n" + std::string(infoLog);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return result;
+    if (result.errorLog.empty()) {
+        glGetShaderiv(pending.fragmentShader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(pending.fragmentShader, 1024, nullptr, infoLog);
+            result.errorLog = "FRAGMENT SHADER ERROR:\n" + std::string(infoLog);
+        }
     }
 
-    // Link program
-    unsigned int program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
+    result.compileMs += millisecondsSince(compileQueryStart);
 
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 1024, nullptr, infoLog);
-        result.errorLog = "SHADER LINK ERROR:\n" + std::string(infoLog);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        glDeleteProgram(program);
-        return result;
+    if (result.errorLog.empty()) {
+        auto linkQueryStart = std::chrono::steady_clock::now();
+        glGetProgramiv(pending.programId, GL_LINK_STATUS, &success);
+        result.linkMs += millisecondsSince(linkQueryStart);
+        if (!success) {
+            glGetProgramInfoLog(pending.programId, 1024, nullptr, infoLog);
+            result.errorLog = "SHADER LINK ERROR:\n" + std::string(infoLog);
+        }
     }
 
     // Cleanup shaders (they're now part of the program)
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    glDeleteShader(pending.vertexShader);
+    glDeleteShader(pending.fragmentShader);
+
+    if (!result.errorLog.empty()) {
+        glDeleteProgram(pending.programId);
+        return result;
+    }
 
     result.success = true;
-    result.programId = program;
+    result.programId = pending.programId;
     return result;
 }
 
+ShaderCompileResult ShaderLayer::tryCompileShader(const std::string& vertexSrc, const std::string& fragmentSrc) {
+    return collectProgramResult(beginCompile(vertexSrc, fragmentSrc));
+}
+
+void ShaderLayer::submitProgram(const std::string& vertexSrc, const std::string& fragmentSrc,
+                                std::function<void(const ShaderCompileResult&)> onComplete) {
+    if (!parallelCompile_) {
+        // No driver threads: status queries would block anyway, so finish right away
+        onComplete(tryCompileShader(vertexSrc, fragmentSrc));
+        return;
+    }
+
+    PendingProgram pending = beginCompile(vertexSrc, fragmentSrc);
+    pending.onComplete = std::move(onComplete);
+    pendingPrograms_.push_back(std::move(pending));
+}
+
+void ShaderLayer::pollPendingPrograms() {
+    // Callbacks may submit new programs, so finished slots are moved out first
+    std::vector<PendingProgram> finished;
+    for (auto it = pendingPrograms_.begin(); it != pendingPrograms_.end();) {
+        int done = GL_FALSE;
+        glGetProgramiv(it->programId, GL_COMPLETION_STATUS_KHR, &done);
+        if (done) {
+            finished.push_back(std::move(*it));
+            it = pendingPrograms_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto& pending : finished) {
+        // Compile and link ran together on driver threads; book the wait as compile time
+        pending.compileMs += millisecondsSince(pending.submitTime);
+        pending.onComplete(collectProgramResult(pending));
+    }
+}
+
 //------------------------------------------------------------------------------
 // File operations
 //------------------------------------------------------------------------------
@@ -183,8 +284,12 @@ bool ShaderLayer::loadShader(const std::string& fragmentPath) {
         return false;
     }
 
+    ReloadTiming timing;
+
     // Preprocess shader (handles #include directives)
+    auto preprocessStart = std::chrono::steady_clock::now();
     auto preprocessResult = ShaderPreprocessing::ShaderPreprocessor::process(fragmentPath);
+    timing.preprocessMs = millisecondsSince(preprocessStart);
     
     if (!preprocessResult.success) {
         lastError_ = "Preprocessing failed: " + preprocessResult.errorMessage;
@@ -197,21 +302,50 @@ bool ShaderLayer::loadShader(const std::string& fragmentPath) {
     // Store dependencies for hot-reload tracking
     shaderDependencies_ = preprocessResult.dependencies;
 
-    // Try to compile
-    ShaderCompileResult result = tryCompileShader(getDefaultVertexShader(), fragmentSrc);
-    
+    // Submit the compile; with parallel compile support the result arrives in a later frame
+    // and only the newest request is activated (older hot-reloads are discarded)
+    unsigned int generation = ++loadGeneration_;
+    submitProgram(getDefaultVertexShader(), fragmentSrc,
+        [this, generation, fragmentPath, fragmentSrc, timing](const ShaderCompileResult& result) {
+            if (generation != loadGeneration_) {
+                if (result.success) {
+                    glDeleteProgram(result.programId);
+                }
+                return;
+            }
+            activateProgram(result, fragmentPath, fragmentSrc, timing);
+        });
+
+    return lastError_.empty();
+}
+
+void ShaderLayer::activateProgram(const ShaderCompileResult& result, const std::string& fragmentPath,
+                                  const std::string& fragmentSrc, ReloadTiming timing) {
+    timing.compileMs = result.compileMs;
+    timing.linkMs = result.linkMs;
+
     if (!result.success) {
         lastError_ = result.errorLog;
         Logger::Error("ShaderLayer", "Compilation failed:\n" + lastError_, {"shader", "compile"});
-        return false;
+        recordReloadTiming(fragmentPath, timing);
+        if (onCompileFinishedCallback_) onCompileFinishedCallback_(false);
+        return;
     }
 
-    // Success! Delete old shader and use new one
-    if (shaderProgram_ != 0) {
-        glDeleteProgram(shaderProgram_);
-    }
+    // Success! Delete old shader (and its variants) and use new one
+    deleteVariant(costVariant_);
+    deleteVariant(prepassVariant_);
     shaderProgram_ = result.programId;
+    programOwner_ = shareProgram(shaderProgram_);
     shaderSource_ = fragmentSrc;
+
+    // Without time or mouse inputs a cached layer only re-renders on changes
+    usesTime_ = glGetUniformLocation(shaderProgram_, "iTime") != -1 ||
+                glGetUniformLocation(shaderProgram_, "iTimeDelta") != -1 ||
+                glGetUniformLocation(shaderProgram_, "iFrame") != -1 ||
+                glGetUniformLocation(shaderProgram_, "iDate") != -1;
+    usesMouse_ = glGetUniformLocation(shaderProgram_, "iMouse") != -1;
+    invalidate();
     lastModTime_ = getFileModTime(fragmentPath);
     
     // Update dependency mod times
@@ -229,6 +363,7 @@ bool ShaderLayer::loadShader(const std::string& fragmentPath) {
     }
     
     // Parse annotated uniforms from preprocessed source
+    auto parseStart = std::chrono::steady_clock::now();
     uniforms_ = Uniforms::UniformParser::parse(fragmentSrc);
     
     // Restore previous values for uniforms that still exist (preserve user tweaks!)
@@ -254,8 +389,12 @@ bool ShaderLayer::loadShader(const std::string& fragmentPath) {
         }, uniformVariant);
     }
     
+    timing.parseMs = millisecondsSince(parseStart);  // Includes restoring the previous values
+
     // Update uniform locations for the new shader program
+    auto locationsStart = std::chrono::steady_clock::now();
     Uniforms::UniformEditor::updateLocations(uniforms_, shaderProgram_);
+    timing.locationsMs = millisecondsSince(locationsStart);
 
     std::filesystem::path shaderFilename(fragmentPath);
     Logger::Info("ShaderLayer", "Shader loaded: " + shaderFilename.filename().string(), {"shader", "io"});
@@ -268,11 +407,158 @@ bool ShaderLayer::loadShader(const std::string& fragmentPath) {
         }
         Logger::Debug("ShaderLayer", "Hot-reload enabled for all dependencies", {"shader"});
     }
-    return true;
+
+    timing.success = true;
+    recordReloadTiming(fragmentPath, timing);
+
+    compileVariants();
+
+    if (onCompileFinishedCallback_) onCompileFinishedCallback_(true);
+}
+
+//------------------------------------------------------------------------------
+// Shader variants (cost heatmap, depth prepass)
+//------------------------------------------------------------------------------
+void ShaderLayer::setCostHeatmapEnabled(bool enabled) {
+    if (enabled == costHeatmapEnabled_) {
+        return;
+    }
+    costHeatmapEnabled_ = enabled;
+    invalidate();
+    if (enabled) {
+        compileVariants();
+    } else {
+        deleteVariant(costVariant_);
+    }
+}
+
+void ShaderLayer::setDepthPrepassEnabled(bool enabled) {
+    if (enabled == depthPrepassEnabled_) {
+        return;
+    }
+    depthPrepassEnabled_ = enabled;
+    invalidate();
+    if (enabled) {
+        compileVariants();
+    } else {
+        deleteVariant(prepassVariant_);
+    }
+}
+
+void ShaderLayer::compileVariants() {
+    if (shaderSource_.empty()) {
+        return;
+    }
+
+    if (costHeatmapEnabled_ && costVariant_.programId == 0) {
+        auto instrumented = ShaderPreprocessing::ShaderPreprocessor::instrumentCostLoops(shaderSource_);
+        if (instrumented.success) {
+            compileVariant(instrumented.source, costVariant_, costHeatmapEnabled_, "Cost heatmap");
+        }
+    }
+
+    if (depthPrepassEnabled_ && prepassVariant_.programId == 0) {
+        if (supportsDepthPrepass()) {
+            std::string prepassSource = ShaderPreprocessing::ShaderPreprocessor::addDefine(shaderSource_, "KIWI_DEPTH_PREPASS");
+            compileVariant(prepassSource, prepassVariant_, depthPrepassEnabled_, "Depth prepass");
+        } else {
+            Logger::Info("ShaderLayer", "Shader has no KIWI_DEPTH_PREPASS path, prepass skipped", {"shader", "perf"});
+        }
+    }
+}
+
+void ShaderLayer::compileVariant(const std::string& source, ShaderVariant& variant, const bool& enabled, const std::string& label) {
+    // Tied to the current load; a reload in between makes this result stale
+    unsigned int generation = loadGeneration_;
+    submitProgram(getDefaultVertexShader(), source,
+        [this, generation, &variant, &enabled, label](const ShaderCompileResult& result) {
+            if (generation != loadGeneration_ || !enabled) {
+                if (result.success) {
+                    glDeleteProgram(result.programId);
+                }
+                return;
+            }
+            if (!result.success) {
+                Logger::Error("ShaderLayer", label + " variant compilation failed:\n" + result.errorLog, {"shader", "compile"});
+                return;
+            }
+            deleteVariant(variant);
+            variant.programId = result.programId;
+            variant.uniformLocations = Uniforms::UniformEditor::queryLocations(uniforms_, variant.programId);
+            Logger::Info("ShaderLayer", label + " variant ready", {"shader", "perf"});
+            invalidate();
+        });
+}
+
+void ShaderLayer::deleteVariant(ShaderVariant& variant) {
+    if (variant.programId != 0) {
+        glDeleteProgram(variant.programId);
+    }
+    variant = ShaderVariant{};
+}
+
+//------------------------------------------------------------------------------
+// Reload timing history
+//------------------------------------------------------------------------------
+void ShaderLayer::recordReloadTiming(const std::string& fragmentPath, ReloadTiming timing) {
+    timing.totalMs = timing.preprocessMs + timing.compileMs + timing.linkMs + timing.parseMs + timing.locationsMs;
+
+    auto& history = reloadHistory_[fragmentPath];
+    history.push_back(timing);
+    if (history.size() > MAX_RELOAD_HISTORY) {
+        history.pop_front();
+    }
+
+    std::filesystem::path shaderFilename(fragmentPath);
+    Logger::Info("ShaderLayer", std::format(
+        "Reload timing [{}] preprocess={:.2f}ms compile={:.2f}ms link={:.2f}ms parse={:.2f}ms locations={:.2f}ms total={:.2f}ms{}",
+        shaderFilename.filename().string(), timing.preprocessMs, timing.compileMs, timing.linkMs,
+        timing.parseMs, timing.locationsMs, timing.totalMs, timing.success ? "" : " (failed)"),
+        {"shader", "perf"});
+}
+
+const std::deque<ReloadTiming>& ShaderLayer::getReloadHistory() const {
+    static const std::deque<ReloadTiming> empty;
+    auto it = reloadHistory_.find(shaderPath_);
+    return it != reloadHistory_.end() ? it->second : empty;
+}
+
+bool ShaderLayer::saveReloadHistory(const std::string& path) const {
+    nlohmann::json root = nlohmann::json::object();
+    for (const auto& [shaderPath, history] : reloadHistory_) {
+        nlohmann::json entries = nlohmann::json::array();
+        for (const auto& timing : history) {
+            nlohmann::json entry;
+            entry["preprocess_ms"] = timing.preprocessMs;
+            entry["compile_ms"] = timing.compileMs;
+            entry["link_ms"] = timing.linkMs;
+            entry["parse_ms"] = timing.parseMs;
+            entry["locations_ms"] = timing.locationsMs;
+            entry["total_ms"] = timing.totalMs;
+            entry["success"] = timing.success;
+            entries.push_back(entry);
+        }
+        root[shaderPath] = entries;
+    }
+
+    try {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            Logger::Error("ShaderLayer", "Could not write reload timings to: " + path, {"shader", "perf", "io"});
+            return false;
+        }
+        file << root.dump(4);
+        Logger::Info("ShaderLayer", "Reload timings saved to: " + path, {"shader", "perf", "io"});
+        return true;
+    } catch (const std::exception& e) {
+        Logger::Error("ShaderLayer", "Error saving reload timings: " + std::string(e.what()), {"shader", "perf", "io"});
+        return false;
+    }
 }
 
 bool ShaderLayer::checkAndReload() {
-    if (!autoReload_ || shaderPath_.empty()) {
+    // Wait for an in-flight compile before looking at the files again
+    if (!autoReload_ || shaderPath_.empty() || isCompiling()) {
         return false;
     }
 
@@ -316,14 +602,38 @@ void ShaderLayer::resetUniforms() {
 //------------------------------------------------------------------------------
 // Rendering
 //------------------------------------------------------------------------------
-void ShaderLayer::render(float windowWidth, float windowHeight, double time, double deltaTime) {
+void ShaderLayer::beginFrame(float windowWidth, float windowHeight) {
     resolution_ = glm::vec2(windowWidth, windowHeight);
     
     // Update camera aspect ratio
     cameraController_.setAspectRatio(windowWidth / windowHeight);
 
-    // Check for hot reload
-    checkAndReload();
+    // Finish any compiles the driver completed since last frame, then check for hot reload
+    if (!changesPolled_) {
+        pollPendingPrograms();
+        checkAndReload();
+    }
+    changesPolled_ = false;
+    if (inputSource_) followInputSource();
+    renderedCameraState_ = cameraController_.getState();
+}
+
+void ShaderLayer::followInputSource() {
+    const ShaderLayer& source = *inputSource_;
+    mousePosition_ = source.mousePosition_;
+    mouseClickPosition_ = source.mouseClickPosition_;
+    mouseDown_ = source.mouseDown_;
+
+    // Keep this layer's aspect ratio, views may differ in size
+    float aspectRatio = cameraController_.getState().aspectRatio;
+    cameraController_.getState() = source.cameraController_.getState();
+    cameraController_.getState().aspectRatio = aspectRatio;
+
+    if (linkUniforms_) Uniforms::UniformEditor::copyValues(source.uniforms_, uniforms_);
+}
+
+void ShaderLayer::render(float windowWidth, float windowHeight, double time, double deltaTime) {
+    beginFrame(windowWidth, windowHeight);
 
     // If no valid shader, just clear to a dark color
     if (shaderProgram_ == 0) {
@@ -342,63 +652,251 @@ void ShaderLayer::render(float windowWidth, float windowHeight, double time, dou
         glGetQueryObjectui64v(gpuTimerQueries_[previousQuery], GL_QUERY_RESULT, &timeElapsed);
         gpuFrameTime_ = static_cast<double>(timeElapsed) / 1000000.0; // Convert nanoseconds to milliseconds
     }
+
+    // Let the governor react to the measured GPU time while the view is being navigated
+    bool interacting = mouseDown_ || cameraMovedSinceLastFrame();
+    qualityGovernor_.update(gpuFrameTime_, interacting, deltaTime);
     
     // Start GPU timer for this frame
     glBeginQuery(GL_TIME_ELAPSED, gpuTimerQueries_[currentQuery_]);
 
-    // Use shader and set uniforms
-    GL_TRY(glUseProgram(shaderProgram_));
+    // Coarse cone-marched pass first, so the full-resolution pass can start its rays late
+    prepassValid_ = depthPrepassEnabled_ && prepassVariant_.programId != 0 && renderDepthPrepass(time, deltaTime);
+
+    // In heatmap mode the instrumented variant renders into the cost capture target
+    bool costMode = costHeatmapEnabled_ && costVariant_.programId != 0 &&
+                    costHeatmap_.begin(static_cast<int>(windowWidth), static_cast<int>(windowHeight));
+    if (costMode) {
+        drawProgram(costVariant_.programId, &costVariant_.uniformLocations, time, deltaTime);
+        costHeatmap_.end(quadVAO_);
+    } else {
+        drawProgram(shaderProgram_, nullptr, time, deltaTime);
+    }
+    
+    // End GPU timer
+    glEndQuery(GL_TIME_ELAPSED);
+    
+    // Swap query buffers for next frame
+    currentQuery_ = 1 - currentQuery_;
+}
 
-    // Shadertoy-compatible uniforms
+glm::vec4 ShaderLayer::getMouseUniform() const {
+    // iMouse: xy = current pos (if down), zw = click pos (negated while the button is up)
+    glm::vec2 pixelPos = (mousePosition_ * 0.5f + 0.5f) * resolution_;
+    glm::vec2 clickPixelPos = (mouseClickPosition_ * 0.5f + 0.5f) * resolution_;
+    if (mouseDown_) {
+        return {pixelPos.x, pixelPos.y, clickPixelPos.x, clickPixelPos.y};
+    }
+    return {pixelPos.x, pixelPos.y, -clickPixelPos.x, -clickPixelPos.y};
+}
+
+void ShaderLayer::bindShadertoyUniforms(unsigned int program, glm::vec2 resolution, double time, double deltaTime,
+                                        glm::vec4 mouse) {
     GLint loc;
     
-    loc = glGetUniformLocation(shaderProgram_, "iTime");
+    loc = glGetUniformLocation(program, "iTime");
     if (loc != -1) glUniform1f(loc, static_cast<float>(time));
 
-    loc = glGetUniformLocation(shaderProgram_, "iTimeDelta");
+    loc = glGetUniformLocation(program, "iTimeDelta");
     if (loc != -1) glUniform1f(loc, static_cast<float>(deltaTime));
 
-    loc = glGetUniformLocation(shaderProgram_, "iResolution");
-    if (loc != -1) glUniform3f(loc, windowWidth, windowHeight, 1.0f);
+    // Always the full resolution, so the prepass traces the same camera rays
+    loc = glGetUniformLocation(program, "iResolution");
+    if (loc != -1) glUniform3f(loc, resolution.x, resolution.y, 1.0f);
 
-    // iMouse: xy = current pos (if down), zw = click pos
-    loc = glGetUniformLocation(shaderProgram_, "iMouse");
-    if (loc != -1) {
-        glm::vec2 pixelPos = (mousePosition_ * 0.5f + 0.5f) * resolution_;
-        glm::vec2 clickPixelPos = (mouseClickPosition_ * 0.5f + 0.5f) * resolution_;
-        if (mouseDown_) {
-            glUniform4f(loc, pixelPos.x, pixelPos.y, clickPixelPos.x, clickPixelPos.y);
-        } else {
-            glUniform4f(loc, pixelPos.x, pixelPos.y, -clickPixelPos.x, -clickPixelPos.y);
-        }
+    loc = glGetUniformLocation(program, "iMouse");
+    if (loc != -1) glUniform4f(loc, mouse.x, mouse.y, mouse.z, mouse.w);
+}
+
+void ShaderLayer::drawProgram(unsigned int program, std::vector<int>* variantLocations, double time, double deltaTime) {
+    // Use shader and set uniforms
+    GL_TRY(glUseProgram(program));
+
+    // Shadertoy-compatible uniforms
+    bindShadertoyUniforms(program, resolution_, time, deltaTime, getMouseUniform());
+    GLint loc;
+
+    // Depth prepass inputs (see depthPrepassStart() in sdf/operations.glsl)
+    loc = glGetUniformLocation(program, "iDepthPrepassFactor");
+    if (loc != -1) glUniform1f(loc, static_cast<float>(depthPrepassDownscale_));
+
+    loc = glGetUniformLocation(program, "iDepthPrepassEnabled");
+    if (loc != -1) glUniform1i(loc, prepassValid_ && program != prepassVariant_.programId ? 1 : 0);
+
+    loc = glGetUniformLocation(program, "iDepthPrepass");
+    if (loc != -1 && program != prepassVariant_.programId) {
+        glActiveTexture(GL_TEXTURE0 + DEPTH_PREPASS_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, prepassTexture_);
+        glActiveTexture(GL_TEXTURE0);
+        glUniform1i(loc, DEPTH_PREPASS_TEXTURE_UNIT);
     }
 
-    // Bind custom annotated uniforms
-    Uniforms::UniformEditor::bindUniforms(uniforms_, shaderProgram_);
+    // Bind custom annotated uniforms (variants keep their own locations)
+    qualityGovernor_.apply(uniforms_);
+    if (variantLocations) {
+        Uniforms::UniformEditor::bindUniforms(uniforms_, program, *variantLocations);
+    } else {
+        Uniforms::UniformEditor::bindUniforms(uniforms_, program);
+    }
+    qualityGovernor_.restore(uniforms_);
     
     // Set camera uniforms (if shader uses them)
-    cameraController_.setShaderUniforms(shaderProgram_);
+    cameraController_.setShaderUniforms(program);
 
     // Draw fullscreen quad
     GL_TRY(glBindVertexArray(quadVAO_));
     GL_TRY(glDrawArrays(GL_TRIANGLES, 0, 6));
     GL_TRY(glBindVertexArray(0));
-    
-    // End GPU timer
-    glEndQuery(GL_TIME_ELAPSED);
-    
-    // Swap query buffers for next frame
-    currentQuery_ = 1 - currentQuery_;
+}
+
+//------------------------------------------------------------------------------
+// Render thread
+//------------------------------------------------------------------------------
+bool ShaderLayer::supportsRenderThread() const {
+    return shaderProgram_ != 0 && !costHeatmapEnabled_ && !depthPrepassEnabled_;
+}
+
+std::function<void()> ShaderLayer::captureRenderJob(const RenderThread& thread, float windowWidth, float windowHeight,
+                                                    double time, double deltaTime) {
+    beginFrame(windowWidth, windowHeight);
+
+    // The render thread times the frames it draws
+    gpuFrameTime_ = thread.getGpuFrameTime();
+    bool interacting = mouseDown_ || cameraMovedSinceLastFrame();
+    qualityGovernor_.update(gpuFrameTime_, interacting, deltaTime);
+
+    ShaderFrameSnapshot snapshot;
+    snapshot.program = programOwner_;
+    snapshot.quadBuffer = quadVBO_;
+    snapshot.resolution = resolution_;
+    snapshot.time = time;
+    snapshot.deltaTime = deltaTime;
+    snapshot.mouse = getMouseUniform();
+    qualityGovernor_.apply(uniforms_);
+    snapshot.uniforms = uniforms_;
+    qualityGovernor_.restore(uniforms_);
+    snapshot.camera = cameraController_;
+
+    return [snapshot = std::move(snapshot)]() mutable {
+        drawSnapshot(snapshot);
+    };
+}
+
+void ShaderLayer::drawSnapshot(ShaderFrameSnapshot& snapshot) {
+    if (!snapshot.program) return;
+    unsigned int program = *snapshot.program;
+    glUseProgram(program);
+
+    bindShadertoyUniforms(program, snapshot.resolution, snapshot.time, snapshot.deltaTime, snapshot.mouse);
+    GLint loc = glGetUniformLocation(program, "iDepthPrepassEnabled");
+    if (loc != -1) glUniform1i(loc, 0);
+    Uniforms::UniformEditor::bindUniforms(snapshot.uniforms, program);
+    snapshot.camera.setShaderUniforms(program);
+
+    // The quad buffer is shared, vertex arrays are not: point the render thread's one at it
+    glBindBuffer(GL_ARRAY_BUFFER, snapshot.quadBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+//------------------------------------------------------------------------------
+// Depth prepass
+//------------------------------------------------------------------------------
+void ShaderLayer::ensureDepthPrepassTarget(int width, int height) {
+    if (prepassFramebuffer_ == 0) {
+        glGenFramebuffers(1, &prepassFramebuffer_);
+        glGenTextures(1, &prepassTexture_);
+    }
+    if (width == prepassWidth_ && height == prepassHeight_) {
+        return;
+    }
+    prepassWidth_ = width;
+    prepassHeight_ = height;
+
+    glBindTexture(GL_TEXTURE_2D, prepassTexture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, prepassFramebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, prepassTexture_, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        Logger::Error("ShaderLayer", "Depth prepass framebuffer is incomplete", {"graphics"});
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+}
+
+bool ShaderLayer::renderDepthPrepass(double time, double deltaTime) {
+    int downscale = std::max(depthPrepassDownscale_, 1);
+    int width = (static_cast<int>(resolution_.x) + downscale - 1) / downscale;
+    int height = (static_cast<int>(resolution_.y) + downscale - 1) / downscale;
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    ensureDepthPrepassTarget(width, height);
+
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, prepassFramebuffer_);
+    glViewport(0, 0, width, height);
+
+    // The prepass must not sample its own target
+    prepassValid_ = false;
+    drawProgram(prepassVariant_.programId, &prepassVariant_.uniformLocations, time, deltaTime);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    return true;
+}
+
+bool ShaderLayer::needsRender() {
+    // A cached layer is not rendered while idle, so compiles and file changes are polled here
+    pollPendingPrograms();
+    checkAndReload();
+    changesPolled_ = true;
+
+    if (KiwiLayer::needsRender() || usesTime_ || shaderProgram_ == 0 || isCompiling()) return true;
+    if (costHeatmapEnabled_ || qualityGovernor_.isReducing()) return true;
+
+    const Camera3DState& state = cameraController_.getState();
+    return state.position != renderedCameraState_.position || state.pitch != renderedCameraState_.pitch ||
+           state.yaw != renderedCameraState_.yaw || state.roll != renderedCameraState_.roll ||
+           state.fov != renderedCameraState_.fov || state.orthoSize != renderedCameraState_.orthoSize;
+}
+
+bool ShaderLayer::cameraMovedSinceLastFrame() {
+    const Camera3DState& state = cameraController_.getState();
+    bool moved = state.position != lastCameraState_.position ||
+                 state.pitch != lastCameraState_.pitch ||
+                 state.yaw != lastCameraState_.yaw ||
+                 state.roll != lastCameraState_.roll ||
+                 state.fov != lastCameraState_.fov ||
+                 state.orthoSize != lastCameraState_.orthoSize;
+    lastCameraState_ = state;
+    return moved;
 }
 
 //------------------------------------------------------------------------------
 // Input handling
 //------------------------------------------------------------------------------
 void ShaderLayer::updateMousePosition(glm::vec2 normalizedPosition) {
+    if (usesMouse_ && normalizedPosition != mousePosition_) invalidate();
     mousePosition_ = normalizedPosition;
 }
 
 void ShaderLayer::handleMouseEvent(MouseEvent mouseEvent) {
+    if (usesMouse_ && mouseEvent.type != MouseEvent::Type::Enter) invalidate();
     if (mouseEvent.type == MouseEvent::Type::Click) {
         mouseDown_ = true;
         mouseClickPosition_ = mouseEvent.position;
@@ -8,9 +8,19 @@
 #include <fstream>
 #include <sstream>
 #include <regex>
+#include <mutex>
 
 namespace ShaderPreprocessing {
 
+// Include files shared by all shaders, keyed by absolute path
+struct CachedInclude {
+    std::filesystem::file_time_type modTime;
+    std::string contents;
+};
+static std::mutex includeCacheMutex;
+static std::unordered_map<std::string, CachedInclude> includeCache;
+static IncludeCacheStats includeCacheStats;
+
 //------------------------------------------------------------------------------
 // Public API
 //------------------------------------------------------------------------------
@@ -78,6 +88,126 @@ PreprocessResult ShaderPreprocessor::processSource(const std::string& source, co
     return result;
 }
 
+//------------------------------------------------------------------------------
+// Cost instrumentation
+//------------------------------------------------------------------------------
+InstrumentResult ShaderPreprocessor::instrumentCostLoops(const std::string& source) {
+    InstrumentResult result;
+
+    std::regex directiveRegex(R"(^\s*#\s*(version|extension)\b)");
+    std::regex annotationRegex(R"(^\s*//\s*@costloop\b)");
+    std::regex loopRegex(R"(^\s*(for|while)\s*\()");
+    std::regex mainRegex(R"(\bvoid\s+main\s*\(\s*(void)?\s*\))");
+
+    std::vector<std::string> lines;
+    std::istringstream stream(source);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+
+    size_t headerLine = 0;       // Globals go after #version / #extension
+    bool awaitingLoop = false;   // Saw @costloop, looking for the loop header
+    int braceSearchLines = 0;    // Lines left to find the loop's opening brace
+    bool foundMain = false;
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        std::string& current = lines[i];
+        int lineNumber = static_cast<int>(i) + 1;
+
+        if (std::regex_search(current, directiveRegex)) {
+            headerLine = i + 1;
+            continue;
+        }
+
+        if (std::regex_search(current, annotationRegex)) {
+            awaitingLoop = true;
+            continue;
+        }
+
+        bool blank = current.find_first_not_of(" \t\r") == std::string::npos;
+        if (awaitingLoop && !blank) {
+            awaitingLoop = false;
+            if (std::regex_search(current, loopRegex)) {
+                braceSearchLines = 2;  // Header line, or a brace on the next line
+            } else {
+                Logger::Warn("ShaderPreprocessor", "@costloop at line " + std::to_string(lineNumber - 1) +
+                             " is not followed by a for/while loop", {"shader", "preprocessor"});
+            }
+        }
+
+        if (braceSearchLines > 0 && !blank) {
+            size_t brace = current.find('{');
+            if (brace != std::string::npos) {
+                current.insert(brace + 1, " kiwiCostCounter += 1.0;");
+                result.instrumentedLoops++;
+                braceSearchLines = 0;
+            } else if (--braceSearchLines == 0) {
+                Logger::Warn("ShaderPreprocessor", "@costloop loop near line " + std::to_string(lineNumber) +
+                             " has no braced body, skipped", {"shader", "preprocessor"});
+            }
+        }
+
+        if (std::regex_search(current, mainRegex)) {
+            current = std::regex_replace(current, mainRegex, "void kiwiUserMain()");
+            foundMain = true;
+        }
+    }
+
+    if (!foundMain) {
+        result.errorMessage = "Cost instrumentation failed: no main() found";
+        Logger::Error("ShaderPreprocessor", result.errorMessage, {"shader", "preprocessor"});
+        return result;
+    }
+
+    std::stringstream out;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i == headerLine) {
+            out << "// BEGIN COST INSTRUMENTATION\n"
+                << "float kiwiCostCounter = 0.0;\n"
+                << "layout(location = 1) out float kiwiCostOut;\n"
+                << "// END COST INSTRUMENTATION\n";
+        }
+        out << lines[i] << "\n";
+    }
+    out << "\nvoid main() {\n"
+        << "    kiwiUserMain();\n"
+        << "    kiwiCostOut = kiwiCostCounter;\n"
+        << "}\n";
+
+    if (result.instrumentedLoops == 0) {
+        Logger::Warn("ShaderPreprocessor", "No @costloop loops found, cost heatmap will be empty", {"shader", "preprocessor"});
+    }
+
+    result.success = true;
+    result.source = out.str();
+    return result;
+}
+
+std::string ShaderPreprocessor::addDefine(const std::string& source, const std::string& name) {
+    std::regex directiveRegex(R"(^\s*#\s*(version|extension)\b)");
+    std::regex commentOrBlankRegex(R"(^\s*(//.*)?\r?$)");
+
+    std::stringstream out;
+    std::istringstream stream(source);
+    std::string line;
+    bool inserted = false;
+    bool inHeader = true;
+    while (std::getline(stream, line)) {
+        // The header (directives, comments, blank lines) ends at the first line of code
+        if (inHeader && !std::regex_search(line, directiveRegex) && !std::regex_search(line, commentOrBlankRegex)) {
+            out << "#define " << name << "\n";
+            inserted = true;
+            inHeader = false;
+        }
+        out << line << "\n";
+    }
+    if (!inserted) {
+        out << "#define " << name << "\n";
+    }
+    return out.str();
+}
+
 //------------------------------------------------------------------------------
 // Helper functions
 //------------------------------------------------------------------------------
@@ -126,6 +256,22 @@ std::string ShaderPreprocessor::resolveIncludePath(const std::string& includePat
 }
 
 std::string ShaderPreprocessor::loadFile(const std::string& path) {
+    std::error_code error;
+    std::string key = std::filesystem::absolute(path, error).string();
+    std::filesystem::file_time_type modTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return "";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(includeCacheMutex);
+        auto it = includeCache.find(key);
+        if (it != includeCache.end() && it->second.modTime == modTime) {
+            includeCacheStats.hits++;
+            return it->second.contents;
+        }
+    }
+
     std::ifstream file(path);
     if (!file.is_open()) {
         return "";
@@ -133,7 +279,24 @@ std::string ShaderPreprocessor::loadFile(const std::string& path) {
     
     std::stringstream buffer;
     buffer << file.rdbuf();
-    return buffer.str();
+    std::string contents = buffer.str();
+
+    std::lock_guard<std::mutex> lock(includeCacheMutex);
+    includeCache[key] = {modTime, contents};
+    includeCacheStats.reads++;
+    return contents;
+}
+
+IncludeCacheStats ShaderPreprocessor::getIncludeCacheStats() {
+    std::lock_guard<std::mutex> lock(includeCacheMutex);
+    IncludeCacheStats stats = includeCacheStats;
+    stats.files = includeCache.size();
+    return stats;
+}
+
+void ShaderPreprocessor::clearIncludeCache() {
+    std::lock_guard<std::mutex> lock(includeCacheMutex);
+    includeCache.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+/**
+ * @file SpatialIndex2D.cpp
+ * @brief Implementation of the uniform-grid spatial index.
+ */
+
+#include "utility/SpatialIndex2D.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Boxes covering more cells than this are tested on every query instead
+static constexpr int64_t MAX_CELLS_PER_BOX = 256;
+
+glm::ivec2 SpatialGrid2D::cellOf(glm::vec2 point) const {
+    return {(int) std::floor(point.x / cellSize_), (int) std::floor(point.y / cellSize_)};
+}
+
+int64_t SpatialGrid2D::key(int x, int y) {
+    return (int64_t(x) << 32) ^ int64_t(uint32_t(y));
+}
+
+void SpatialGrid2D::setCellSize(float cellSize) {
+    if (cellSize <= 0.0f || cellSize == cellSize_) return;
+
+    for (size_t id = 0; id < entries_.size(); id++) {
+        if (entries_[id].present) unlink(id);
+    }
+    cellSize_ = cellSize;
+    for (size_t id = 0; id < entries_.size(); id++) {
+        Entry& entry = entries_[id];
+        if (!entry.present) continue;
+        entry.cells = glm::ivec4(cellOf({entry.box.x, entry.box.y}), cellOf({entry.box.z, entry.box.w}));
+        link(id);
+    }
+}
+
+void SpatialGrid2D::update(size_t id, const glm::vec4& box) {
+    if (id >= entries_.size()) entries_.resize(id + 1);
+    Entry& entry = entries_[id];
+
+    bool empty = box.x > box.z || box.y > box.w;
+    if (empty) {
+        if (entry.present) unlink(id);
+        entry.present = false;
+        return;
+    }
+
+    glm::ivec2 minCell = cellOf({box.x, box.y});
+    glm::ivec2 maxCell = cellOf({box.z, box.w});
+    glm::ivec4 cells(minCell, maxCell);
+
+    // Same cells: only the box used for the exact test changes
+    if (entry.present && cells == entry.cells) {
+        entry.box = box;
+        return;
+    }
+
+    if (entry.present) unlink(id);
+    entry.box = box;
+    entry.cells = cells;
+    entry.present = true;
+    link(id);
+}
+
+void SpatialGrid2D::remove(size_t id) {
+    if (id >= entries_.size() || !entries_[id].present) return;
+    unlink(id);
+    entries_[id].present = false;
+}
+
+void SpatialGrid2D::clear() {
+    entries_.clear();
+    cells_.clear();
+    oversized_.clear();
+}
+
+void SpatialGrid2D::link(size_t id) {
+    Entry& entry = entries_[id];
+    int64_t count = int64_t(entry.cells.z - entry.cells.x + 1) * int64_t(entry.cells.w - entry.cells.y + 1);
+    entry.oversized = count > MAX_CELLS_PER_BOX;
+
+    if (entry.oversized) {
+        oversized_.push_back(id);
+        return;
+    }
+
+    for (int y = entry.cells.y; y <= entry.cells.w; y++) {
+        for (int x = entry.cells.x; x <= entry.cells.z; x++) {
+            cells_[key(x, y)].push_back(id);
+        }
+    }
+}
+
+void SpatialGrid2D::unlink(size_t id) {
+    Entry& entry = entries_[id];
+
+    if (entry.oversized) {
+        oversized_.erase(std::remove(oversized_.begin(), oversized_.end(), id), oversized_.end());
+        return;
+    }
+
+    for (int y = entry.cells.y; y <= entry.cells.w; y++) {
+        for (int x = entry.cells.x; x <= entry.cells.z; x++) {
+            auto it = cells_.find(key(x, y));
+            if (it == cells_.end()) continue;
+            std::vector<size_t>& ids = it->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+            if (ids.empty()) cells_.erase(it);
+        }
+    }
+}
+
+void SpatialGrid2D::query(glm::vec2 point, std::vector<size_t>& out) const {
+    auto contains = [&point](const glm::vec4& box) {
+        return point.x > box.x && point.y > box.y && point.x < box.z && point.y < box.w;
+    };
+
+    glm::ivec2 cell = cellOf(point);
+    auto it = cells_.find(key(cell.x, cell.y));
+    if (it != cells_.end()) {
+        for (size_t id: it->second) {
+            if (contains(entries_[id].box)) out.push_back(id);
+        }
+    }
+
+    for (size_t id: oversized_) {
+        if (contains(entries_[id].box)) out.push_back(id);
+    }
+}
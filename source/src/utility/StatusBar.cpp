@@ -12,10 +12,12 @@ StatusBar& StatusBar::getInstance() {
 }
 
 void StatusBar::setState(StatusBarState state) {
+    if (state_ != state) revision_++;
     state_ = state;
 }
 
 void StatusBar::setMessage(const std::string& message) {
+    if (message_ != message) revision_++;
     message_ = message;
 }
 
@@ -31,6 +33,7 @@ void StatusBar::addWidget(const std::string& id, std::function<void()> renderFun
         // Add new widget
         widgets_.emplace_back(id, std::move(renderFunc));
     }
+    revision_++;
 }
 
 void StatusBar::removeWidget(const std::string& id) {
@@ -39,11 +42,13 @@ void StatusBar::removeWidget(const std::string& id) {
     
     if (it != widgets_.end()) {
         widgets_.erase(it);
+        revision_++;
     }
 }
 
 void StatusBar::clearWidgets() {
     widgets_.clear();
+    revision_++;
 }
 
 ImVec4 StatusBar::getBackgroundColor() const {
@@ -0,0 +1,591 @@
+/**
+ * @file Triangulate2D.cpp
+ * @brief Implementation of the ear-clipping triangulator.
+ *
+ * Vertices live in a circular doubly linked list; clipped ears are unlinked.
+ * When no ear is found, the ring is cleaned (duplicate and collinear points),
+ * then local self-intersections are cut off, and as a last resort the ring is
+ * split along a valid diagonal and both halves are triangulated separately.
+ *
+ * Port of earcut (https://github.com/mapbox/earcut), keeping its structure and
+ * function names, under the following license:
+ *
+ * ISC License
+ *
+ * Copyright (c) 2016, Mapbox
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose
+ * with or without fee is hereby granted, provided that the above copyright notice
+ * and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ * THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+ * OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+ * ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "utility/Triangulate2D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+
+// Polygons above this size use z-order hashing in the ear test
+static constexpr size_t MIN_HASHED_VERTICES = 80;
+
+namespace {
+
+struct Node {
+    unsigned int i;         // vertex index
+    double x, y;
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    uint32_t z = 0;         // z-order curve value
+    Node* prevZ = nullptr;
+    Node* nextZ = nullptr;
+    bool steiner = false;   // single-point hole, never filtered
+};
+
+class EarClipper {
+public:
+    explicit EarClipper(std::vector<unsigned int>& triangles) : triangles_(triangles) {}
+
+    void run(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts);
+
+private:
+    Node* linkedList(const std::vector<glm::vec2>& vertices, size_t start, size_t end, bool counterClockwise);
+    Node* filterPoints(Node* start, Node* end = nullptr);
+    void earcutLinked(Node* ear, int pass);
+    [[nodiscard]] bool isEar(Node* ear) const;
+    [[nodiscard]] bool isEarHashed(Node* ear) const;
+    Node* cureLocalIntersections(Node* start);
+    void splitEarcut(Node* start);
+    Node* eliminateHoles(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts, Node* outer);
+    Node* eliminateHole(Node* hole, Node* outer);
+    [[nodiscard]] static Node* findHoleBridge(Node* hole, Node* outer);
+    void indexCurve(Node* start) const;
+    [[nodiscard]] uint32_t zOrder(double x, double y) const;
+
+    Node* insertNode(unsigned int i, glm::vec2 point, Node* last);
+    static void removeNode(Node* p);
+    Node* splitPolygon(Node* a, Node* b);
+    void emit(const Node* a, const Node* b, const Node* c);
+
+    std::vector<unsigned int>& triangles_;
+    std::deque<Node> nodes_;    // stable addresses
+
+    bool hashed_ = false;
+    double minX_ = 0.0, minY_ = 0.0, invSize_ = 0.0;
+};
+
+// Negative for a counter-clockwise (convex) turn p -> q -> r
+double area(const Node* p, const Node* q, const Node* r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+bool equals(const Node* a, const Node* b) {
+    return a->x == b->x && a->y == b->y;
+}
+
+bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+int sign(double value) {
+    return (value > 0.0) - (value < 0.0);
+}
+
+// q lies on segment pr, given that p, q, r are collinear
+bool onSegment(const Node* p, const Node* q, const Node* r) {
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+           q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2) {
+    int o1 = sign(area(p1, q1, p2));
+    int o2 = sign(area(p1, q1, q2));
+    int o3 = sign(area(p2, q2, p1));
+    int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) return true;
+    if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+    if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+    if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+    if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+    return false;
+}
+
+bool intersectsPolygon(const Node* a, const Node* b) {
+    const Node* p = a;
+    do {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+            intersects(p, p->next, a, b)) return true;
+        p = p->next;
+    } while (p != a);
+    return false;
+}
+
+// Diagonal ab starts inside the polygon at a
+bool locallyInside(const Node* a, const Node* b) {
+    return area(a->prev, a, a->next) < 0 ?
+           area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+           area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// Midpoint of diagonal ab is inside the polygon
+bool middleInside(const Node* a, const Node* b) {
+    const Node* p = a;
+    bool inside = false;
+    double px = (a->x + b->x) / 2.0;
+    double py = (a->y + b->y) / 2.0;
+    do {
+        if ((p->y > py) != (p->next->y > py) && p->next->y != p->y &&
+            px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x) {
+            inside = !inside;
+        }
+        p = p->next;
+    } while (p != a);
+    return inside;
+}
+
+bool isValidDiagonal(const Node* a, const Node* b) {
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+           ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+             (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||
+            (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0));
+}
+
+bool sectorContainsSector(const Node* m, const Node* p) {
+    return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+}
+
+Node* getLeftmost(Node* start) {
+    Node* p = start;
+    Node* leftmost = start;
+    do {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) leftmost = p;
+        p = p->next;
+    } while (p != start);
+    return leftmost;
+}
+
+// Merge sort of the z-order list
+Node* sortLinked(Node* list) {
+    size_t inSize = 1;
+    size_t numMerges;
+    do {
+        Node* p = list;
+        Node* tail = nullptr;
+        list = nullptr;
+        numMerges = 0;
+
+        while (p) {
+            numMerges++;
+            Node* q = p;
+            size_t pSize = 0;
+            for (size_t i = 0; i < inSize; i++) {
+                pSize++;
+                q = q->nextZ;
+                if (!q) break;
+            }
+            size_t qSize = inSize;
+
+            while (pSize > 0 || (qSize > 0 && q)) {
+                Node* e;
+                if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                } else {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+
+                if (tail) tail->nextZ = e;
+                else list = e;
+                e->prevZ = tail;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->nextZ = nullptr;
+        inSize *= 2;
+    } while (numMerges > 1);
+    return list;
+}
+
+//------------------------------------------------------------------------------
+// EarClipper
+//------------------------------------------------------------------------------
+void EarClipper::run(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts) {
+    size_t outerEnd = holeStarts.empty() ? vertices.size() : holeStarts.front();
+    Node* outer = linkedList(vertices, 0, outerEnd, true);
+    if (!outer || outer->next == outer->prev) return;
+
+    if (!holeStarts.empty()) outer = eliminateHoles(vertices, holeStarts, outer);
+
+    if (vertices.size() > MIN_HASHED_VERTICES) {
+        double maxX = minX_ = vertices[0].x;
+        double maxY = minY_ = vertices[0].y;
+        for (size_t i = 1; i < outerEnd; i++) {
+            minX_ = std::min(minX_, double(vertices[i].x));
+            minY_ = std::min(minY_, double(vertices[i].y));
+            maxX = std::max(maxX, double(vertices[i].x));
+            maxY = std::max(maxY, double(vertices[i].y));
+        }
+        double size = std::max(maxX - minX_, maxY - minY_);
+        invSize_ = size != 0.0 ? 32767.0 / size : 0.0;
+        hashed_ = invSize_ != 0.0;
+    }
+
+    earcutLinked(outer, 0);
+}
+
+Node* EarClipper::linkedList(const std::vector<glm::vec2>& vertices, size_t start, size_t end, bool counterClockwise) {
+    if (end <= start) return nullptr;
+
+    Node* last = nullptr;
+    if (counterClockwise == (signedArea2D(vertices.data() + start, end - start) > 0.0)) {
+        for (size_t i = start; i < end; i++) last = insertNode((unsigned int) i, vertices[i], last);
+    } else {
+        for (size_t i = end; i-- > start;) last = insertNode((unsigned int) i, vertices[i], last);
+    }
+
+    if (last && equals(last, last->next)) {
+        removeNode(last);
+        last = last->next;
+    }
+    return last;
+}
+
+Node* EarClipper::filterPoints(Node* start, Node* end) {
+    if (!start) return start;
+    if (!end) end = start;
+
+    Node* p = start;
+    bool again;
+    do {
+        again = false;
+        if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0)) {
+            removeNode(p);
+            p = end = p->prev;
+            if (p == p->next) break;
+            again = true;
+        } else {
+            p = p->next;
+        }
+    } while (again || p != end);
+    return end;
+}
+
+void EarClipper::earcutLinked(Node* ear, int pass) {
+    if (!ear) return;
+    if (pass == 0 && hashed_) indexCurve(ear);
+
+    Node* stop = ear;
+    while (ear->prev != ear->next) {
+        Node* prev = ear->prev;
+        Node* next = ear->next;
+
+        if (hashed_ ? isEarHashed(ear) : isEar(ear)) {
+            emit(prev, ear, next);
+            removeNode(ear);
+
+            // Skipping the next vertex leads to fewer sliver triangles
+            ear = next->next;
+            stop = next->next;
+            continue;
+        }
+
+        ear = next;
+        if (ear == stop) {
+            // No ear left: clean up, then cure self-intersections, then split
+            if (pass == 0) {
+                earcutLinked(filterPoints(ear), 1);
+            } else if (pass == 1) {
+                ear = cureLocalIntersections(filterPoints(ear));
+                earcutLinked(ear, 2);
+            } else {
+                splitEarcut(ear);
+            }
+            break;
+        }
+    }
+}
+
+bool EarClipper::isEar(Node* ear) const {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+    if (area(a, b, c) >= 0) return false;   // reflex
+
+    double x0 = std::min({a->x, b->x, c->x}), y0 = std::min({a->y, b->y, c->y});
+    double x1 = std::max({a->x, b->x, c->x}), y1 = std::max({a->y, b->y, c->y});
+
+    // Only reflex vertices can be inside the ear
+    for (const Node* p = c->next; p != a; p = p->next) {
+        if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+            pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            area(p->prev, p, p->next) >= 0) return false;
+    }
+    return true;
+}
+
+bool EarClipper::isEarHashed(Node* ear) const {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+    if (area(a, b, c) >= 0) return false;
+
+    double x0 = std::min({a->x, b->x, c->x}), y0 = std::min({a->y, b->y, c->y});
+    double x1 = std::max({a->x, b->x, c->x}), y1 = std::max({a->y, b->y, c->y});
+    uint32_t minZ = zOrder(x0, y0);
+    uint32_t maxZ = zOrder(x1, y1);
+
+    auto blocks = [&](const Node* p) {
+        return p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && p != a && p != c &&
+               pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+               area(p->prev, p, p->next) >= 0;
+    };
+
+    // Walk the z-order list in both directions within the ear's z range
+    const Node* p = ear->prevZ;
+    const Node* n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+        if (blocks(p)) return false;
+        p = p->prevZ;
+        if (blocks(n)) return false;
+        n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ) {
+        if (blocks(p)) return false;
+    }
+    for (; n && n->z <= maxZ; n = n->nextZ) {
+        if (blocks(n)) return false;
+    }
+    return true;
+}
+
+Node* EarClipper::cureLocalIntersections(Node* start) {
+    Node* p = start;
+    do {
+        Node* a = p->prev;
+        Node* b = p->next->next;
+
+        if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+            emit(a, p, b);
+            removeNode(p);
+            removeNode(p->next);
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return filterPoints(p);
+}
+
+void EarClipper::splitEarcut(Node* start) {
+    Node* a = start;
+    do {
+        for (Node* b = a->next->next; b != a->prev; b = b->next) {
+            if (a->i != b->i && isValidDiagonal(a, b)) {
+                Node* c = splitPolygon(a, b);
+                a = filterPoints(a, a->next);
+                c = filterPoints(c, c->next);
+                earcutLinked(a, 0);
+                earcutLinked(c, 0);
+                return;
+            }
+        }
+        a = a->next;
+    } while (a != start);
+}
+
+Node* EarClipper::eliminateHoles(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts,
+                                 Node* outer) {
+    std::vector<Node*> queue;
+    for (size_t h = 0; h < holeStarts.size(); h++) {
+        size_t start = holeStarts[h];
+        size_t end = h + 1 < holeStarts.size() ? holeStarts[h + 1] : vertices.size();
+        Node* list = linkedList(vertices, start, end, false);
+        if (!list) continue;
+        if (list == list->next) list->steiner = true;
+        queue.push_back(getLeftmost(list));
+    }
+
+    // Bridge holes from left to right
+    std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+    for (Node* hole: queue) outer = eliminateHole(hole, outer);
+    return outer;
+}
+
+Node* EarClipper::eliminateHole(Node* hole, Node* outer) {
+    Node* bridge = findHoleBridge(hole, outer);
+    if (!bridge) return outer;
+
+    Node* bridgeReverse = splitPolygon(bridge, hole);
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    return filterPoints(bridge, bridge->next);
+}
+
+Node* EarClipper::findHoleBridge(Node* hole, Node* outer) {
+    Node* p = outer;
+    double hx = hole->x;
+    double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node* m = nullptr;
+
+    // Closest outer segment left of the hole point, intersected by a horizontal ray
+    do {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+            double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if (x == hx) return m;  // the hole touches the outer segment
+            }
+        }
+        p = p->next;
+    } while (p != outer);
+
+    if (!m) return nullptr;
+
+    // Reflex vertices inside the triangle (hole point, ray hit, m) would block the
+    // bridge; use the one with the smallest angle to the ray instead
+    Node* stop = m;
+    double mx = m->x;
+    double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+
+    p = m;
+    do {
+        if (hx >= p->x && p->x >= mx && hx != p->x &&
+            pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+            double tan = std::abs(hy - p->y) / (hx - p->x);
+            if (locallyInside(p, hole) &&
+                (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                m = p;
+                tanMin = tan;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+
+    return m;
+}
+
+void EarClipper::indexCurve(Node* start) const {
+    Node* p = start;
+    do {
+        if (p->z == 0) p->z = zOrder(p->x, p->y);
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while (p != start);
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+    sortLinked(p);
+}
+
+// Interleaved bits of the coordinates scaled to 15 bits
+uint32_t EarClipper::zOrder(double px, double py) const {
+    auto x = uint32_t(int32_t((px - minX_) * invSize_));
+    auto y = uint32_t(int32_t((py - minY_) * invSize_));
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+Node* EarClipper::insertNode(unsigned int i, glm::vec2 point, Node* last) {
+    Node& p = nodes_.emplace_back();
+    p.i = i;
+    p.x = point.x;
+    p.y = point.y;
+
+    if (!last) {
+        p.prev = &p;
+        p.next = &p;
+    } else {
+        p.next = last->next;
+        p.prev = last;
+        last->next->prev = &p;
+        last->next = &p;
+    }
+    return &p;
+}
+
+void EarClipper::removeNode(Node* p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+// Link a and b with a bridge; returns the copy of b on the split-off ring
+Node* EarClipper::splitPolygon(Node* a, Node* b) {
+    Node& a2 = nodes_.emplace_back(Node{a->i, a->x, a->y});
+    Node& b2 = nodes_.emplace_back(Node{b->i, b->x, b->y});
+    Node* an = a->next;
+    Node* bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2.next = an;
+    an->prev = &a2;
+
+    b2.next = &a2;
+    a2.prev = &b2;
+
+    bp->next = &b2;
+    b2.prev = bp;
+
+    return &b2;
+}
+
+void EarClipper::emit(const Node* a, const Node* b, const Node* c) {
+    triangles_.push_back(a->i);
+    triangles_.push_back(b->i);
+    triangles_.push_back(c->i);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// API
+//------------------------------------------------------------------------------
+double signedArea2D(const glm::vec2* ring, size_t count) {
+    if (count < 3) return 0.0;
+
+    double sum = 0.0;
+    for (size_t i = 0, j = count - 1; i < count; j = i++) {
+        sum += double(ring[j].x) * ring[i].y - double(ring[i].x) * ring[j].y;
+    }
+    return sum * 0.5;
+}
+
+void triangulatePolygon2D(const std::vector<glm::vec2>& vertices, const std::vector<size_t>& holeStarts,
+                          std::vector<unsigned int>& indices) {
+    indices.clear();
+    if (vertices.size() < 3) return;
+
+    EarClipper clipper(indices);
+    clipper.run(vertices, holeStarts);
+}
@@ -141,6 +141,28 @@ void UniformEditor::resetToDefaults(UniformCollection& collection) {
     }
 }
 
+//------------------------------------------------------------------------------
+// Copy values between collections (matched by name and type)
+//------------------------------------------------------------------------------
+bool UniformEditor::copyValues(const UniformCollection& source, UniformCollection& target) {
+    bool changed = false;
+    for (auto& uniform : target.uniforms) {
+        std::visit([&source, &changed](auto& u) {
+            using T = std::decay_t<decltype(u)>;
+            for (const auto& candidate : source.uniforms) {
+                const T* match = std::get_if<T>(&candidate);
+                if (!match || match->name != u.name) continue;
+                if (match->value != u.value) {
+                    u.value = match->value;
+                    changed = true;
+                }
+                break;
+            }
+        }, uniform);
+    }
+    return changed;
+}
+
 //------------------------------------------------------------------------------
 // Update uniform locations from shader program
 //------------------------------------------------------------------------------
@@ -152,6 +174,35 @@ void UniformEditor::updateLocations(UniformCollection& collection, unsigned int
     }
 }
 
+std::vector<int> UniformEditor::queryLocations(const UniformCollection& collection, unsigned int programId) {
+    std::vector<int> locations;
+    locations.reserve(collection.uniforms.size());
+    for (const auto& uniform : collection.uniforms) {
+        std::visit([programId, &locations](const auto& u) {
+            locations.push_back(glGetUniformLocation(programId, u.name.c_str()));
+        }, uniform);
+    }
+    return locations;
+}
+
+void UniformEditor::bindUniforms(UniformCollection& collection, unsigned int programId, std::vector<int>& locations) {
+    if (locations.size() != collection.uniforms.size()) {
+        return;  // Stale locations (collection was re-parsed)
+    }
+
+    // Swap the variant's locations in, bind, and swap the originals back
+    auto swapLocations = [&collection, &locations]() {
+        for (size_t i = 0; i < locations.size(); ++i) {
+            std::visit([&locations, i](auto& u) {
+                std::swap(u.location, locations[i]);
+            }, collection.uniforms[i]);
+        }
+    };
+    swapLocations();
+    bindUniforms(collection, programId);
+    swapLocations();
+}
+
 //------------------------------------------------------------------------------
 // Individual control renderers
 //------------------------------------------------------------------------------
@@ -298,6 +298,7 @@ std::optional<UniformVariant> UniformParser::parseSlider(
         u.defaultValue = static_cast<float>(AnnotationParser::getNumber(params, "default", 0.0));
         u.value = u.defaultValue;
         u.step = static_cast<float>(AnnotationParser::getNumber(params, "step", 0.01));
+        u.quality = AnnotationParser::getBool(params, "quality", false);
         
         return u;
     }
@@ -311,6 +312,7 @@ std::optional<UniformVariant> UniformParser::parseSlider(
         u.maxValue = static_cast<int>(AnnotationParser::getNumber(params, "max", 100.0));
         u.defaultValue = static_cast<int>(AnnotationParser::getNumber(params, "default", 0.0));
         u.value = u.defaultValue;
+        u.quality = AnnotationParser::getBool(params, "quality", false);
         
         return u;
     }
@@ -1552,3 +1552,11 @@ unsigned char ColormapTables::blackbody_table[512][3] = {
     };
 
 
+const unsigned char (*ColormapTables::getTable(Colormap colormap))[3] {
+    switch (colormap) {
+        case Colormap::Blackbody: return blackbody_table;
+        case Colormap::Coolwarm: return coolwarm_table;
+        case Colormap::Viridis:
+        default: return viridis_table;
+    }
+}
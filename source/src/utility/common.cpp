@@ -1,4 +1,9 @@
+
 #include "utility/common.h"
+#include "utility/Logger.h"
+
+#include <cstdlib>
+#include <string>
 
 
 void GLClearError() {
@@ -15,3 +20,82 @@ void GLClearError() {
 
     return true;
 }
+
+//------------------------------------------------------------------------------
+// KHR_debug output
+//------------------------------------------------------------------------------
+bool GLDiagnosticsRequested() {
+#ifdef KIWI_GL_DIAGNOSTICS
+    bool enabled = true;
+#else
+    bool enabled = false;
+#endif
+    if (const char* env = std::getenv("KIWI_GL_DEBUG")) {
+        enabled = std::string(env) != "0";
+    }
+    return enabled;
+}
+
+static const char* debugSourceName(GLenum source) {
+    switch (source) {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window System";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third Party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+        default: return "Other";
+    }
+}
+
+static const char* debugTypeName(GLenum type) {
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        case GL_DEBUG_TYPE_MARKER: return "marker";
+        default: return "other";
+    }
+}
+
+static void APIENTRY onDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                    GLsizei length, const GLchar* message, const void* /*userParam*/) {
+    std::string text = std::string("[") + debugSourceName(source) + ", " + debugTypeName(type) +
+                       ", id " + std::to_string(id) + "] " + std::string(message, length);
+    std::vector<std::string> tags = {"graphics", "opengl"};
+    if (type == GL_DEBUG_TYPE_PERFORMANCE) tags.emplace_back("performance");
+
+    if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH) {
+        Logger::Error("OpenGL", text, tags);
+    } else if (severity == GL_DEBUG_SEVERITY_MEDIUM || type == GL_DEBUG_TYPE_PERFORMANCE) {
+        Logger::Warn("OpenGL", text, tags);
+    } else if (severity == GL_DEBUG_SEVERITY_LOW) {
+        Logger::Debug("OpenGL", text, tags);
+    } else {
+        Logger::Trace("OpenGL", text, tags);
+    }
+}
+
+void GLInstallDebugOutput() {
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) {
+        Logger::Warn("OpenGL", "Diagnostics requested but the context is not a debug context", {"graphics", "opengl"});
+        return;
+    }
+    if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_KHR_debug) {
+        Logger::Warn("OpenGL", "KHR_debug is not supported, diagnostics disabled", {"graphics", "opengl"});
+        return;
+    }
+
+    // Synchronous: messages arrive on the calling thread, inside the offending call
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(onDebugMessage, nullptr);
+
+    // Notifications (buffer placement info, ...) are too chatty for the console
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+    Logger::Info("OpenGL", "Debug output enabled", {"graphics", "opengl"});
+}
@@ -2,8 +2,11 @@
 #include "utility/common.h"
 
 #include <glm/ext.hpp>
+#include <cstring>
 
 
+unsigned int Shader::boundProgram = 0;
+
 Shader::Shader(const std::string &filename) : renderer_id(0) {
     std::string vertexShader;
     std::string geometryShader;
@@ -11,7 +14,8 @@ Shader::Shader(const std::string &filename) : renderer_id(0) {
     parseShader(filename, vertexShader, geometryShader, fragmentShader);
     unsigned int shader = createShader(vertexShader, geometryShader, fragmentShader);
     renderer_id = shader;
-    GL_TRY(glUseProgram(renderer_id));
+    cacheUniformLocations();
+    bind();
     std::cout << "Shader in!\n";
 }
 
@@ -20,76 +24,132 @@ Shader::Shader(const std::string &vertexShader, const std::string &fragmentShade
 
     unsigned int shader = createShader(vertexShader, "", fragmentShader);
     renderer_id = shader;
-    GL_TRY(glUseProgram(renderer_id));
+    cacheUniformLocations();
+    bind();
     std::cout << "Shader in!\n";
 }
 
 
 Shader::~Shader() {
     std::cout << "Shader out!\n";
+    if (boundProgram == renderer_id) boundProgram = 0;
     glDeleteProgram(renderer_id);
 }
 
 void Shader::bind() const {
+    if (boundProgram == renderer_id) return;
     GL_TRY(glUseProgram(renderer_id));
+    boundProgram = renderer_id;
 }
 
 void Shader::unbind() const {
     GL_TRY(glUseProgram(0));
+    boundProgram = 0;
+}
+
+void Shader::invalidateBinding() {
+    boundProgram = 0;
 }
 
 
 void Shader::setUniform4f(const std::string &name, float f0, float f1, float f2, float f3) {
     this->bind();
-    int location = getUniformLocation(name);
-    glUniform4f(location, f0, f1, f2, f3);
+    UniformSlot &slot = getUniformSlot(name);
+    const float value[] = {f0, f1, f2, f3};
+    if (!storeUniformValue(slot, value, 4)) return;
+    glUniform4f(slot.location, f0, f1, f2, f3);
 }
 
 void Shader::setUniform3f(const std::string &name, float f0, float f1, float f2) {
     this->bind();
-    int location = getUniformLocation(name);
-    glUniform3f(location, f0, f1, f2);
+    UniformSlot &slot = getUniformSlot(name);
+    const float value[] = {f0, f1, f2};
+    if (!storeUniformValue(slot, value, 3)) return;
+    glUniform3f(slot.location, f0, f1, f2);
 }
 
 void Shader::setUniform2f(const std::string &name, float f0, float f1) {
     this->bind();
-    int location = getUniformLocation(name);
-    glUniform2f(location, f0, f1);
+    UniformSlot &slot = getUniformSlot(name);
+    const float value[] = {f0, f1};
+    if (!storeUniformValue(slot, value, 2)) return;
+    glUniform2f(slot.location, f0, f1);
 }
 
 void Shader::setUniform1f(const std::string &name, float f0) {
     this->bind();
-    int location = getUniformLocation(name);
-    glUniform1f(location, f0);
+    UniformSlot &slot = getUniformSlot(name);
+    if (!storeUniformValue(slot, &f0, 1)) return;
+    glUniform1f(slot.location, f0);
 }
 
 void Shader::setUniform4x4f(const std::string &name, glm::mat4 i) {
     this->bind();
-    int location = getUniformLocation(name);
-    GL_TRY(glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(i)));
+    UniformSlot &slot = getUniformSlot(name);
+    if (!storeUniformValue(slot, glm::value_ptr(i), 16)) return;
+    GL_TRY(glUniformMatrix4fv(slot.location, 1, GL_FALSE, glm::value_ptr(i)));
 }
 
 void Shader::setUniform3x3f(const std::string &name, glm::mat3 i) {
     this->bind();
-    int location = getUniformLocation(name);
-    GL_TRY(glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(i)));
+    UniformSlot &slot = getUniformSlot(name);
+    if (!storeUniformValue(slot, glm::value_ptr(i), 9)) return;
+    GL_TRY(glUniformMatrix3fv(slot.location, 1, GL_FALSE, glm::value_ptr(i)));
 }
 
 void Shader::setUniform1i(const std::string &name, int i) {
     this->bind();
-    int location = getUniformLocation(name);
-    glUniform1i(location, i);
+    UniformSlot &slot = getUniformSlot(name);
+    float value;
+    memcpy(&value, &i, sizeof(int));
+    if (!storeUniformValue(slot, &value, 1)) return;
+    glUniform1i(slot.location, i);
 }
 
-int Shader::getUniformLocation(const std::string &name) const {
-    GL_TRY(
-            int location = glGetUniformLocation(renderer_id, name.c_str())
-    );
-    if (location == -1) {
-        std::cout << "[OpenGL Error]: uniform \"" << name << "\" doesn't exist!" << std::endl;
+void Shader::cacheUniformLocations() {
+    uniformSlots.clear();
+    slots.clear();
+
+    int count = 0;
+    glGetProgramiv(renderer_id, GL_ACTIVE_UNIFORMS, &count);
+
+    char name[256];
+    for (int index = 0; index < count; index++) {
+        int length = 0, size = 0;
+        unsigned int type = 0;
+        glGetActiveUniform(renderer_id, index, sizeof(name), &length, &size, &type, name);
+
+        UniformSlot slot;
+        slot.location = glGetUniformLocation(renderer_id, name);
+        uniformSlots[name] = slots.size();
+
+        // Arrays are reported as "name[0]", also accept the plain name
+        std::string uniformName(name, length);
+        if (uniformName.size() > 3 && uniformName.ends_with("[0]")) {
+            uniformSlots[uniformName.substr(0, uniformName.size() - 3)] = slots.size();
+        }
+        slots.push_back(slot);
     }
+}
+
+Shader::UniformSlot &Shader::getUniformSlot(const std::string &name) {
+    auto it = uniformSlots.find(name);
+    if (it != uniformSlots.end()) return slots[it->second];
+
+    // Not active in the program: report once, later uploads are dropped silently
+    std::cout << "[OpenGL Error]: uniform \"" << name << "\" doesn't exist!" << std::endl;
+    uniformSlots[name] = slots.size();
+    slots.emplace_back();
+    return slots.back();
+}
+
+bool Shader::storeUniformValue(UniformSlot &slot, const float *value, int size) {
+    if (slot.location == -1) return false;
+    if (slot.size == size && memcmp(slot.value, value, size * sizeof(float)) == 0) return false;
 
-    return location;
+    memcpy(slot.value, value, size * sizeof(float));
+    slot.size = size;
+    return true;
 }
 
 